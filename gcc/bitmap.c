@@ -214,12 +214,21 @@ bitmap_elt_clear_from (bitmap head, bitmap_element *elt)
     }
 }
 
-/* Clear a bitmap by freeing the linked list.  */
+/* Clear a bitmap by freeing the linked list.  A tree view bitmap is
+   flattened to a list first and stays in tree view.  */
 
 void
 bitmap_clear (bitmap head)
 {
-  if (head->first)
+  if (head->first == NULL)
+    return;
+  if (head->tree_form)
+    {
+      bitmap_list_view (head);
+      bitmap_elt_clear_from (head, head->first);
+      head->tree_form = true;
+    }
+  else
     bitmap_elt_clear_from (head, head->first);
 }
 
@@ -442,6 +451,8 @@ bitmap_copy (bitmap to, const_bitmap from)
   const bitmap_element *from_ptr;
   bitmap_element *to_ptr = 0;
 
+  gcc_checking_assert (!to->tree_form && !from->tree_form);
+
   bitmap_clear (to);
 
   /* Copy elements in forward direction one at a time.  */
@@ -476,6 +487,8 @@ bitmap_copy (bitmap to, const_bitmap from)
 void
 bitmap_move (bitmap to, bitmap from)
 {
+  gcc_checking_assert (!to->tree_form && !from->tree_form);
+
   gcc_assert (to->obstack == from->obstack);
 
   bitmap_clear (to);
@@ -564,12 +577,222 @@ bitmap_find_bit (bitmap head, unsigned int bit)
   return element;
 }
 
+/* Splay-tree view of bitmaps.
+
+   A bitmap in tree view keeps its elements in a splay tree rooted at
+   HEAD->first, with the PREV and NEXT fields of each element pointing to
+   its left and right child.  This makes random access to bitmaps with
+   many elements O(log E) amortized, where the linked list view needs a
+   walk from the last element accessed.  */
+
+/* Rotate the tree rooted at T to the right and return the new root.  */
+
+static inline bitmap_element *
+bitmap_tree_rotate_right (bitmap_element *t)
+{
+  bitmap_element *l = t->prev;
+  t->prev = l->next;
+  l->next = t;
+  return l;
+}
+
+/* Rotate the tree rooted at T to the left and return the new root.  */
+
+static inline bitmap_element *
+bitmap_tree_rotate_left (bitmap_element *t)
+{
+  bitmap_element *r = t->next;
+  t->next = r->prev;
+  r->prev = t;
+  return r;
+}
+
+/* Top-down splay of the tree rooted at T, a subtree of HEAD, for INDX.
+   Return the new root, which is the element with index INDX if there is
+   one, or else its predecessor or successor.  */
+
+static bitmap_element *
+bitmap_tree_splay (bitmap head, bitmap_element *t, unsigned int indx)
+{
+  bitmap_element N, *l, *r;
+
+  if (t == NULL)
+    return NULL;
+
+  bitmap_usage *usage = NULL;
+  if (GATHER_STATISTICS)
+    usage = bitmap_mem_desc.get_descriptor_for_instance (head);
+
+  N.prev = N.next = NULL;
+  l = r = &N;
+
+  while (indx != t->indx)
+    {
+      if (GATHER_STATISTICS && usage)
+	usage->m_search_iter++;
+
+      if (indx < t->indx)
+	{
+	  if (t->prev != NULL && indx < t->prev->indx)
+	    t = bitmap_tree_rotate_right (t);
+	  if (t->prev == NULL)
+	    break;
+	  r->prev = t;
+	  r = t;
+	  t = t->prev;
+	}
+      else
+	{
+	  if (t->next != NULL && indx > t->next->indx)
+	    t = bitmap_tree_rotate_left (t);
+	  if (t->next == NULL)
+	    break;
+	  l->next = t;
+	  l = t;
+	  t = t->next;
+	}
+    }
+
+  l->next = t->prev;
+  r->prev = t->next;
+  t->prev = N.next;
+  t->next = N.prev;
+  return t;
+}
+
+/* Find the element with index INDX in the tree view bitmap HEAD, and
+   make it the root of the tree.  Return NULL if there is none.  */
+
+static inline bitmap_element *
+bitmap_tree_find_element (bitmap head, unsigned int indx)
+{
+  if (head->first == NULL
+      || head->first->indx == indx)
+    return head->first;
+
+  if (GATHER_STATISTICS)
+    {
+      bitmap_usage *usage = bitmap_mem_desc.get_descriptor_for_instance (head);
+      if (usage)
+	usage->m_nsearches++;
+    }
+
+  head->first = bitmap_tree_splay (head, head->first, indx);
+  if (head->first->indx != indx)
+    return NULL;
+  return head->first;
+}
+
+/* Link the element E, whose index is not yet in the tree view bitmap
+   HEAD, into HEAD as the new root.  */
+
+static void
+bitmap_tree_link_element (bitmap head, bitmap_element *e)
+{
+  if (head->first == NULL)
+    e->prev = e->next = NULL;
+  else
+    {
+      bitmap_element *t = bitmap_tree_splay (head, head->first, e->indx);
+      if (e->indx < t->indx)
+	{
+	  e->prev = t->prev;
+	  e->next = t;
+	  t->prev = NULL;
+	}
+      else
+	{
+	  gcc_checking_assert (e->indx > t->indx);
+	  e->next = t->next;
+	  e->prev = t;
+	  t->next = NULL;
+	}
+    }
+  head->first = e;
+}
+
+/* Unlink the element E from the tree view bitmap HEAD.  */
+
+static void
+bitmap_tree_unlink_element (bitmap head, bitmap_element *e)
+{
+  bitmap_element *t = bitmap_tree_splay (head, head->first, e->indx);
+
+  gcc_checking_assert (t == e);
+
+  if (e->prev == NULL)
+    t = e->next;
+  else
+    {
+      /* All of the left subtree is below E, so splaying it for E's index
+	 brings its maximum to the root, which has no right child.  */
+      t = bitmap_tree_splay (head, e->prev, e->indx);
+      t->next = e->next;
+    }
+  head->first = t;
+  e->prev = e->next = NULL;
+}
+
+/* Switch the list view bitmap HEAD to the tree view.  The sorted list
+   becomes a degenerate tree of right children, which the first few
+   splays will balance.  */
+
+void
+bitmap_tree_view (bitmap head)
+{
+  bitmap_element *ptr;
+
+  gcc_assert (!head->tree_form);
+
+  for (ptr = head->first; ptr; ptr = ptr->next)
+    ptr->prev = NULL;
+
+  head->current = NULL;
+  head->indx = 0;
+  head->tree_form = true;
+}
+
+/* Switch the tree view bitmap HEAD back to the list view.  */
+
+void
+bitmap_list_view (bitmap head)
+{
+  bitmap_element **link, *ptr, *prev;
+
+  gcc_assert (head->tree_form);
+
+  /* Rotate left children up until the tree is a sorted chain of right
+     children, then fill in the back links.  */
+  link = &head->first;
+  while ((ptr = *link) != NULL)
+    {
+      if (ptr->prev)
+	*link = bitmap_tree_rotate_right (ptr);
+      else
+	link = &ptr->next;
+    }
+
+  prev = NULL;
+  for (ptr = head->first; ptr; ptr = ptr->next)
+    {
+      ptr->prev = prev;
+      prev = ptr;
+    }
+
+  head->current = head->first;
+  head->indx = head->first ? head->first->indx : 0;
+  head->tree_form = false;
+}
+
 /* Clear a single bit in a bitmap.  Return true if the bit changed.  */
 
 bool
 bitmap_clear_bit (bitmap head, int bit)
 {
-  bitmap_element *const ptr = bitmap_find_bit (head, bit);
+  bitmap_element *const ptr
+    = (head->tree_form
+       ? bitmap_tree_find_element (head, bit / BITMAP_ELEMENT_ALL_BITS)
+       : bitmap_find_bit (head, bit));
 
   if (ptr != 0)
     {
@@ -583,7 +806,17 @@ bitmap_clear_bit (bitmap head, int bit)
 	  /* If we cleared the entire word, free up the element.  */
 	  if (!ptr->bits[word_num]
 	      && bitmap_element_zerop (ptr))
-	    bitmap_element_free (head, ptr);
+	    {
+	      if (!head->tree_form)
+		bitmap_element_free (head, ptr);
+	      else
+		{
+		  bitmap_tree_unlink_element (head, ptr);
+		  if (GATHER_STATISTICS)
+		    register_overhead (head, -((int)sizeof (bitmap_element)));
+		  bitmap_elem_to_freelist (head, ptr);
+		}
+	    }
 	}
 
       return res;
@@ -597,7 +830,10 @@ bitmap_clear_bit (bitmap head, int bit)
 bool
 bitmap_set_bit (bitmap head, int bit)
 {
-  bitmap_element *ptr = bitmap_find_bit (head, bit);
+  bitmap_element *ptr
+    = (head->tree_form
+       ? bitmap_tree_find_element (head, bit / BITMAP_ELEMENT_ALL_BITS)
+       : bitmap_find_bit (head, bit));
   unsigned word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
   unsigned bit_num  = bit % BITMAP_WORD_BITS;
   BITMAP_WORD bit_val = ((BITMAP_WORD) 1) << bit_num;
@@ -607,7 +843,10 @@ bitmap_set_bit (bitmap head, int bit)
       ptr = bitmap_element_allocate (head);
       ptr->indx = bit / BITMAP_ELEMENT_ALL_BITS;
       ptr->bits[word_num] = bit_val;
-      bitmap_element_link (head, ptr);
+      if (head->tree_form)
+	bitmap_tree_link_element (head, ptr);
+      else
+	bitmap_element_link (head, ptr);
       return true;
     }
   else
@@ -628,7 +867,10 @@ bitmap_bit_p (bitmap head, int bit)
   unsigned bit_num;
   unsigned word_num;
 
-  ptr = bitmap_find_bit (head, bit);
+  if (head->tree_form)
+    ptr = bitmap_tree_find_element (head, bit / BITMAP_ELEMENT_ALL_BITS);
+  else
+    ptr = bitmap_find_bit (head, bit);
   if (ptr == 0)
     return 0;
 
@@ -692,6 +934,8 @@ bitmap_count_bits (const_bitmap a)
   unsigned long count = 0;
   const bitmap_element *elt;
 
+  gcc_checking_assert (!a->tree_form);
+
   for (elt = a->first; elt; elt = elt->next)
     count += bitmap_count_bits_in_word (elt->bits);
 
@@ -706,6 +950,8 @@ bitmap_count_unique_bits (const_bitmap a, const_bitmap b)
   unsigned long count = 0;
   const bitmap_element *elt_a, *elt_b;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   for (elt_a = a->first, elt_b = b->first; elt_a && elt_b; )
     {
       /* If we're at different indices, then count all the bits
@@ -744,6 +990,8 @@ bitmap_single_bit_set_p (const_bitmap a)
   const bitmap_element *elt;
   unsigned ix;
 
+  gcc_checking_assert (!a->tree_form);
+
   if (bitmap_empty_p (a))
     return false;
 
@@ -781,6 +1029,7 @@ bitmap_first_set_bit (const_bitmap a)
   BITMAP_WORD word;
   unsigned ix;
 
+  gcc_checking_assert (!a->tree_form);
   gcc_checking_assert (elt);
   bit_no = elt->indx * BITMAP_ELEMENT_ALL_BITS;
   for (ix = 0; ix != BITMAP_ELEMENT_WORDS; ix++)
@@ -832,6 +1081,7 @@ bitmap_last_set_bit (const_bitmap a)
   BITMAP_WORD word;
   int ix;
 
+  gcc_checking_assert (!a->tree_form);
   gcc_checking_assert (elt);
   while (elt->next)
     elt = elt->next;
@@ -876,6 +1126,8 @@ bitmap_and (bitmap dst, const_bitmap a, const_bitmap b)
   const bitmap_element *b_elt = b->first;
   bitmap_element *dst_prev = NULL;
 
+  gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
+
   gcc_assert (dst != a && dst != b);
 
   if (a == b)
@@ -934,6 +1186,8 @@ bitmap_and_into (bitmap a, const_bitmap b)
   bitmap_element *next;
   bool changed = false;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   if (a == b)
     return false;
 
@@ -1028,6 +1282,8 @@ bitmap_and_compl (bitmap dst, const_bitmap a, const_bitmap b)
   bitmap_element **dst_prev_pnext = &dst->first;
   bool changed = false;
 
+  gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
+
   gcc_assert (dst != a && dst != b);
 
   if (a == b)
@@ -1139,6 +1395,8 @@ bitmap_and_compl_into (bitmap a, const_bitmap b)
   bitmap_element *next;
   BITMAP_WORD changed = 0;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   if (a == b)
     {
       if (bitmap_empty_p (a))
@@ -1191,6 +1449,8 @@ bitmap_set_range (bitmap head, unsigned int start, unsigned int count)
   bitmap_element *elt, *elt_prev;
   unsigned int i;
 
+  gcc_checking_assert (!head->tree_form);
+
   if (!count)
     return;
 
@@ -1296,6 +1556,8 @@ bitmap_clear_range (bitmap head, unsigned int start, unsigned int count)
   unsigned int first_index, end_bit_plus1, last_index;
   bitmap_element *elt;
 
+  gcc_checking_assert (!head->tree_form);
+
   if (!count)
     return;
 
@@ -1431,6 +1693,8 @@ bitmap_compl_and_into (bitmap a, const_bitmap b)
   bitmap_element *a_prev = NULL;
   bitmap_element *next;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   gcc_assert (a != b);
 
   if (bitmap_empty_p (a))
@@ -1562,6 +1826,8 @@ bitmap_ior (bitmap dst, const_bitmap a, const_bitmap b)
   bitmap_element **dst_prev_pnext = &dst->first;
   bool changed = false;
 
+  gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
+
   gcc_assert (dst != a && dst != b);
 
   while (a_elt || b_elt)
@@ -1610,6 +1876,8 @@ bitmap_ior_into (bitmap a, const_bitmap b)
   bitmap_element **a_prev_pnext = &a->first;
   bool changed = false;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   if (a == b)
     return false;
 
@@ -1648,6 +1916,8 @@ bitmap_xor (bitmap dst, const_bitmap a, const_bitmap b)
   const bitmap_element *b_elt = b->first;
   bitmap_element *dst_prev = NULL;
 
+  gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
+
   gcc_assert (dst != a && dst != b);
   if (a == b)
     {
@@ -1724,6 +1994,8 @@ bitmap_xor_into (bitmap a, const_bitmap b)
   const bitmap_element *b_elt = b->first;
   bitmap_element *a_prev = NULL;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   if (a == b)
     {
       bitmap_clear (a);
@@ -1783,6 +2055,8 @@ bitmap_equal_p (const_bitmap a, const_bitmap b)
   const bitmap_element *b_elt;
   unsigned ix;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   for (a_elt = a->first, b_elt = b->first;
        a_elt && b_elt;
        a_elt = a_elt->next, b_elt = b_elt->next)
@@ -1805,6 +2079,8 @@ bitmap_intersect_p (const_bitmap a, const_bitmap b)
   const bitmap_element *b_elt;
   unsigned ix;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
+
   for (a_elt = a->first, b_elt = b->first;
        a_elt && b_elt;)
     {
@@ -1832,6 +2108,8 @@ bitmap_intersect_compl_p (const_bitmap a, const_bitmap b)
   const bitmap_element *a_elt;
   const bitmap_element *b_elt;
   unsigned ix;
+
+  gcc_checking_assert (!a->tree_form && !b->tree_form);
   for (a_elt = a->first, b_elt = b->first;
        a_elt && b_elt;)
     {
@@ -1867,6 +2145,8 @@ bitmap_ior_and_compl (bitmap dst, const_bitmap a, const_bitmap b, const_bitmap k
   bitmap_element **dst_prev_pnext = &dst->first;
 
   gcc_assert (dst != a && dst != b && dst != kill);
+  gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form
+		       && !kill->tree_form);
 
   /* Special cases.  We don't bother checking for bitmap_equal_p (b, kill).  */
   if (b == kill || bitmap_empty_p (b))
@@ -1966,6 +2246,9 @@ bitmap_ior_and_compl_into (bitmap a, const_bitmap from1, const_bitmap from2)
   bitmap_head tmp;
   bool changed;
 
+  gcc_checking_assert (!a->tree_form && !from1->tree_form
+		       && !from2->tree_form);
+
   bitmap_initialize (&tmp, &bitmap_default_obstack);
   bitmap_and_compl (&tmp, from1, from2);
   changed = bitmap_ior_into (a, &tmp);
@@ -1988,6 +2271,8 @@ bitmap_ior_and_into (bitmap a, const_bitmap b, const_bitmap c)
   bool changed = false;
   unsigned ix;
 
+  gcc_checking_assert (!a->tree_form && !b->tree_form && !c->tree_form);
+
   if (b == c)
     return bitmap_ior_into (a, b);
   if (bitmap_empty_p (b) || bitmap_empty_p (c))
@@ -2061,6 +2346,8 @@ bitmap_hash (const_bitmap head)
   BITMAP_WORD hash = 0;
   int ix;
 
+  gcc_checking_assert (!head->tree_form);
+
   for (ptr = head->first; ptr; ptr = ptr->next)
     {
       hash ^= ptr->indx;
@@ -2078,6 +2365,8 @@ debug_bitmap_file (FILE *file, const_bitmap head)
 {
   const bitmap_element *ptr;
 
+  gcc_checking_assert (!head->tree_form);
+
   fprintf (file, "\nfirst = " HOST_PTR_PRINTF
 	   " current = " HOST_PTR_PRINTF " indx = %u\n",
 	   (void *) head->first, (void *) head->current, head->indx);
@@ -2262,6 +2551,42 @@ test_bitmap_single_bit_set_p ()
   ASSERT_EQ (1066, bitmap_first_set_bit (b));
 }
 
+/* Verify that a bitmap in tree view behaves like one in list view under
+   a random sequence of updates, and survives switching views.  */
+
+static void
+test_tree_view ()
+{
+  bitmap list = bitmap_gc_alloc ();
+  bitmap tree = bitmap_gc_alloc ();
+  bitmap_tree_view (tree);
+
+  unsigned int seed = 1;
+  for (int i = 0; i < 4000; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      int bit = (seed >> 8) % 20000;
+      if (i % 3 == 2)
+	ASSERT_EQ (bitmap_clear_bit (list, bit), bitmap_clear_bit (tree, bit));
+      else
+	ASSERT_EQ (bitmap_set_bit (list, bit), bitmap_set_bit (tree, bit));
+      ASSERT_EQ (bitmap_bit_p (list, bit + 1), bitmap_bit_p (tree, bit + 1));
+    }
+
+  bitmap_list_view (tree);
+  ASSERT_TRUE (bitmap_equal_p (list, tree));
+  bitmap_tree_view (tree);
+  bitmap_list_view (tree);
+  ASSERT_TRUE (bitmap_equal_p (list, tree));
+
+  bitmap_tree_view (tree);
+  bitmap_clear (tree);
+  ASSERT_TRUE (bitmap_empty_p (tree));
+  ASSERT_TRUE (bitmap_set_bit (tree, 5));
+  ASSERT_TRUE (bitmap_bit_p (tree, 5));
+  ASSERT_FALSE (bitmap_bit_p (tree, 6));
+}
+
 /* Run all of the selftests within this file.  */
 
 void
@@ -2272,6 +2597,7 @@ bitmap_c_tests ()
   test_clear_bit_in_middle ();
   test_copying ();
   test_bitmap_single_bit_set_p ();
+  test_tree_view ();
 }
 
 } // namespace selftest
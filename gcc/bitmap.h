@@ -115,6 +115,15 @@ along with GCC; see the file COPYING3.  If not see
 
    Traversing linked lists is usually cache-unfriendly, even with the last
    accessed element cached.
+
+   For sets that are only used for random-access membership tests and
+   updates, a bitmap can be switched to a "tree view" with
+   bitmap_tree_view.  The elements are then kept in a splay tree rather
+   than in a linked list, so that member_p, add_member and remove_member
+   take O(log E) amortized time with any access pattern.  Only those
+   operations and clear are available in tree view; a bitmap must be
+   switched back to the list view with bitmap_list_view before it is used
+   for anything else, which takes O(E) time.
    
    Cache performance can be improved by keeping the elements in the set
    grouped together in memory, using a dedicated obstack for a set (or group
@@ -222,23 +231,28 @@ struct GTY (()) bitmap_obstack {
    element) that are connected by the next fields.  The prev pointer
    is undefined for interior elements.  This allows
    bitmap_elt_clear_from to be implemented in unit time rather than
-   linear in the number of elements to be freed.  */
+   linear in the number of elements to be freed.
+
+   In tree view NEXT and PREV are the right and left children, so the
+   garbage collector walks PREV as an ordinary field, not as a chain.  */
 
-struct GTY((chain_next ("%h.next"), chain_prev ("%h.prev"))) bitmap_element {
-  struct bitmap_element *next;	/* Next element.  */
-  struct bitmap_element *prev;	/* Previous element.  */
+struct GTY((chain_next ("%h.next"))) bitmap_element {
+  struct bitmap_element *next;	/* Next element or right child.  */
+  struct bitmap_element *prev;	/* Previous element or left child.  */
   unsigned int indx;			/* regno/BITMAP_ELEMENT_ALL_BITS.  */
   BITMAP_WORD bits[BITMAP_ELEMENT_WORDS]; /* Bits that are set.  */
 };
 
 /* Head of bitmap linked list.  The 'current' member points to something
-   already pointed to by the chain started by first, so GTY((skip)) it.  */
+   already pointed to by the chain started by first, so GTY((skip)) it.
+
+   In tree view, 'first' is the root of a splay tree whose elements use
+   their 'prev' and 'next' fields for the left and right child, and
+   'current' and 'indx' are unused.  */
 
 struct GTY(()) bitmap_head {
   unsigned int indx;			/* Index of last element looked at.  */
-  unsigned int descriptor_id;		/* Unique identifier for the allocation
-					   site of this bitmap, for detailed
-					   statistics gathering.  */
+  bool tree_form;			/* True if in tree view.  */
   bitmap_element *first;		/* First element in linked list.  */
   bitmap_element * GTY((skip(""))) current; /* Last element looked at.  */
   bitmap_obstack *obstack;		/* Obstack to allocate elements from.
@@ -325,6 +339,10 @@ extern void debug_bitmap_file (FILE *, const_bitmap);
 /* Print a bitmap.  */
 extern void bitmap_print (FILE *, const_bitmap, const char *, const char *);
 
+/* Switch a bitmap between the list and the tree view.  */
+extern void bitmap_list_view (bitmap);
+extern void bitmap_tree_view (bitmap);
+
 /* Initialize and release a bitmap obstack.  */
 extern void bitmap_obstack_initialize (bitmap_obstack *);
 extern void bitmap_obstack_release (bitmap_obstack *);
@@ -338,6 +356,7 @@ static inline void
 bitmap_initialize_stat (bitmap head, bitmap_obstack *obstack MEM_STAT_DECL)
 {
   head->first = head->current = NULL;
+  head->tree_form = false;
   head->obstack = obstack;
   if (GATHER_STATISTICS)
     bitmap_register (head PASS_MEM_STAT);
@@ -404,6 +423,8 @@ bmp_iter_set_init (bitmap_iterator *bi, const_bitmap map,
   bi->elt1 = map->first;
   bi->elt2 = NULL;
 
+  gcc_checking_assert (!map->tree_form);
+
   /* Advance elt1 until it is not before the block containing start_bit.  */
   while (1)
     {
@@ -446,6 +467,8 @@ bmp_iter_and_init (bitmap_iterator *bi, const_bitmap map1, const_bitmap map2,
   bi->elt1 = map1->first;
   bi->elt2 = map2->first;
 
+  gcc_checking_assert (!map1->tree_form && !map2->tree_form);
+
   /* Advance elt1 until it is not before the block containing
      start_bit.  */
   while (1)
@@ -515,6 +538,8 @@ bmp_iter_and_compl_init (bitmap_iterator *bi,
   bi->elt1 = map1->first;
   bi->elt2 = map2->first;
 
+  gcc_checking_assert (!map1->tree_form && !map2->tree_form);
+
   /* Advance elt1 until it is not before the block containing start_bit.  */
   while (1)
     {
@@ -59,6 +59,8 @@ struct c_pch_validity
   unsigned char debug_info_type;
   signed char match[MATCH_SIZE];
   void (*pch_init) (void);
+  void *pch_base;
+  size_t pch_size;
   size_t target_data_length;
 };
 
@@ -78,7 +80,7 @@ static const char *
 get_ident (void)
 {
   static char result[IDENT_LENGTH];
-  static const char templ[] = "gpch.014";
+  static const char templ[] = "gpch.015";
   static const char c_language_chars[] = "Co+O";
 
   memcpy (result, templ, IDENT_LENGTH);
@@ -170,6 +172,9 @@ pch_cpp_save_state (void)
 void
 c_common_write_pch (void)
 {
+  void *pch_base;
+  size_t pch_size;
+
   timevar_push (TV_PCH_SAVE);
 
   targetm.prepare_pch_save ();
@@ -180,7 +185,7 @@ c_common_write_pch (void)
 
   cpp_write_pch_deps (parse_in, pch_outfile);
 
-  gt_pch_save (pch_outfile);
+  gt_pch_save (pch_outfile, &pch_base, &pch_size);
 
   timevar_push (TV_PCH_CPP_SAVE);
   cpp_write_pch_state (parse_in, pch_outfile);
@@ -190,6 +195,15 @@ c_common_write_pch (void)
       || fwrite (get_ident (), IDENT_LENGTH, 1, pch_outfile) != 1)
     fatal_error (input_location, "can%'t write %s: %m", pch_file);
 
+  /* Now that the GC image is laid out, record where it must be mapped,
+     so that a reader can tell up front whether that is still possible.  */
+  if (fseek (pch_outfile,
+	     IDENT_LENGTH + 16 + offsetof (struct c_pch_validity, pch_base),
+	     SEEK_SET) != 0
+      || fwrite (&pch_base, sizeof (pch_base), 1, pch_outfile) != 1
+      || fwrite (&pch_size, sizeof (pch_size), 1, pch_outfile) != 1)
+    fatal_error (input_location, "can%'t write %s: %m", pch_file);
+
   fclose (pch_outfile);
 
   timevar_pop (TV_PCH_SAVE);
@@ -301,6 +315,18 @@ c_common_valid_pch (cpp_reader *pfile, const char *name, int fd)
       return 2;
     }
 
+  /* The GC data in the PCH cannot be relocated, so it is only usable
+     if the memory it was laid out for is still free.  Otherwise reject
+     the file here and fall back to the header, rather than fail hard
+     in gt_pch_restore.  */
+  if (!host_hooks.gt_pch_address_available_p (v.pch_base, v.pch_size))
+    {
+      if (cpp_get_options (pfile)->warn_invalid_pch)
+	cpp_error (pfile, CPP_DL_WARNING,
+		   "%s: the address it must be loaded at is in use", name);
+      return 2;
+    }
+
   /* Check the target-specific validity data.  */
   {
     void *this_file_data = xmalloc (v.target_data_length);
@@ -52,6 +52,8 @@ static macro_queue *define_queue, *undef_queue;
 /* General output routines.  */
 static void scan_translation_unit (cpp_reader *);
 static void print_lines_directives_only (int, const void *, size_t);
+static void discard_lines_directives_only (int, const void *, size_t);
+static void discard_line_directives_only (source_location);
 static void scan_translation_unit_directives_only (cpp_reader *);
 static void scan_translation_unit_trad (cpp_reader *);
 static void account_for_newlines (const unsigned char *, size_t);
@@ -87,10 +89,19 @@ preprocess_file (cpp_reader *pfile)
      cpp_scan_nooutput or cpp_get_token next.  */
   if (flag_no_output && pfile->buffer)
     {
-      /* Scan -included buffers, then the main file.  */
-      while (pfile->buffer->prev)
-	cpp_scan_nooutput (pfile);
-      cpp_scan_nooutput (pfile);
+      /* With -fdirectives-only, only the directives are processed, which
+	 is all that -M needs; the rest of the text isn't even lexed.  */
+      if (cpp_get_options (pfile)->directives_only
+	  && !cpp_get_options (pfile)->preprocessed
+	  && !cpp_get_options (pfile)->traditional)
+	scan_translation_unit_directives_only (pfile);
+      else
+	{
+	  /* Scan -included buffers, then the main file.  */
+	  while (pfile->buffer->prev)
+	    cpp_scan_nooutput (pfile);
+	  cpp_scan_nooutput (pfile);
+	}
     }
   else if (cpp_get_options (pfile)->traditional)
     scan_translation_unit_trad (pfile);
@@ -291,15 +302,36 @@ print_lines_directives_only (int lines, const void *buf, size_t size)
   fwrite (buf, 1, size, print.outf);
 }
 
+static void
+discard_lines_directives_only (int lines ATTRIBUTE_UNUSED,
+			       const void *buf ATTRIBUTE_UNUSED,
+			       size_t size ATTRIBUTE_UNUSED)
+{
+}
+
+static void
+discard_line_directives_only (source_location loc ATTRIBUTE_UNUSED)
+{
+}
+
 /* Writes out the preprocessed file, handling spacing and paste
-   avoidance issues.  */
+   avoidance issues.  If output is suppressed, only process the
+   directives.  */
 static void
 scan_translation_unit_directives_only (cpp_reader *pfile)
 {
   struct _cpp_dir_only_callbacks cb;
 
-  cb.print_lines = print_lines_directives_only;
-  cb.maybe_print_line = (void (*) (source_location)) maybe_print_line;
+  if (flag_no_output)
+    {
+      cb.print_lines = discard_lines_directives_only;
+      cb.maybe_print_line = discard_line_directives_only;
+    }
+  else
+    {
+      cb.print_lines = print_lines_directives_only;
+      cb.maybe_print_line = (void (*) (source_location)) maybe_print_line;
+    }
 
   _cpp_preprocess_dir_only (pfile, &cb);
 }
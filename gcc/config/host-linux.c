@@ -62,6 +62,9 @@
 #undef HOST_HOOKS_GT_PCH_USE_ADDRESS
 #define HOST_HOOKS_GT_PCH_USE_ADDRESS linux_gt_pch_use_address
 
+#undef HOST_HOOKS_GT_PCH_ADDRESS_AVAILABLE_P
+#define HOST_HOOKS_GT_PCH_ADDRESS_AVAILABLE_P linux_gt_pch_address_available_p
+
 /* For various ports, try to guess a fixed spot in the vm space
    that's probably free.  */
 #if defined(__alpha)
@@ -96,6 +99,10 @@
 # define TRY_EMPTY_VM_SPACE	0x8000000000
 #elif defined(__mips__)
 # define TRY_EMPTY_VM_SPACE	0x60000000
+#elif defined(__riscv) && defined(__LP64__)
+# define TRY_EMPTY_VM_SPACE	0x1000000000
+#elif defined(__riscv)
+# define TRY_EMPTY_VM_SPACE	0x60000000
 #else
 # define TRY_EMPTY_VM_SPACE	0
 #endif
@@ -226,5 +233,26 @@ linux_gt_pch_use_address (void *base, size_t size, int fd, size_t offset)
   return 1;
 }
 
+/* Return true if SIZE bytes at BASE are not mapped yet.  Probe with an
+   inaccessible anonymous mapping, which the kernel places at BASE only
+   if the whole range is free.  */
+
+static bool
+linux_gt_pch_address_available_p (void *base, size_t size)
+{
+  void *addr;
+
+  if (size == 0)
+    return true;
+
+  addr = mmap (base, size, PROT_NONE,
+	       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (addr == (void *) MAP_FAILED)
+    return false;
+  munmap (addr, size);
+
+  return addr == base;
+}
+
 
 const struct host_hooks host_hooks = HOST_HOOKS_INITIALIZER;
@@ -328,11 +328,212 @@ static const struct riscv_cpu_info riscv_cpu_info_table[] = {
   { "size", &optimize_size_tune_info },
 };
 
+/* The -mtune prefix that names a tuning description file.  */
+#define RISCV_TUNE_FILE_PREFIX "file:"
+
+/* Costs read from the file named by -mtune=file:PATH.  */
+static struct riscv_tune_info riscv_file_tune_info;
+
+/* The processor described by -mtune=file:PATH.  */
+static const struct riscv_cpu_info riscv_file_cpu_info = {
+  "file", &riscv_file_tune_info
+};
+
+/* A cost field that can be set from a tuning description file.  */
+struct riscv_tune_field
+{
+  /* The key that names the field in the file.  */
+  const char *name;
+
+  /* The field's offset within struct riscv_tune_info.  */
+  size_t offset;
+
+  /* The number of elements: 2 for {SFmode/SImode, DFmode/DImode} pairs.  */
+  unsigned int count;
+
+  /* True if the file gives the cost in instructions, to be scaled by
+     COSTS_N_INSNS.  */
+  bool insns_p;
+};
+
+static const struct riscv_tune_field riscv_tune_fields[] = {
+  { "fp_add", offsetof (struct riscv_tune_info, fp_add), 2, true },
+  { "fp_mul", offsetof (struct riscv_tune_info, fp_mul), 2, true },
+  { "fp_div", offsetof (struct riscv_tune_info, fp_div), 2, true },
+  { "int_mul", offsetof (struct riscv_tune_info, int_mul), 2, true },
+  { "int_div", offsetof (struct riscv_tune_info, int_div), 2, true },
+  { "issue_rate", offsetof (struct riscv_tune_info, issue_rate), 1, false },
+  { "branch_cost", offsetof (struct riscv_tune_info, branch_cost), 1, false },
+  { "memory_cost", offsetof (struct riscv_tune_info, memory_cost), 1, false },
+};
+
+/* Set the field of INFO named KEY to the NVALUES values in VALUES.
+   Return false if KEY is unknown or the values are invalid for it.  */
+
+static bool
+riscv_parse_tune_entry (const char *key, char **values, unsigned int nvalues,
+			struct riscv_tune_info *info)
+{
+  if (nvalues == 0)
+    return false;
+
+  if (strcmp (key, "slow_unaligned_access") == 0)
+    {
+      if (nvalues != 1)
+	return false;
+      if (strcmp (values[0], "true") == 0 || strcmp (values[0], "1") == 0)
+	info->slow_unaligned_access = true;
+      else if (strcmp (values[0], "false") == 0 || strcmp (values[0], "0") == 0)
+	info->slow_unaligned_access = false;
+      else
+	return false;
+      return true;
+    }
+
+  for (unsigned i = 0; i < ARRAY_SIZE (riscv_tune_fields); i++)
+    {
+      const struct riscv_tune_field *field = &riscv_tune_fields[i];
+      if (strcmp (key, field->name) != 0)
+	continue;
+
+      if (nvalues > field->count)
+	return false;
+
+      unsigned short *dest = (unsigned short *) ((char *) info + field->offset);
+      for (unsigned j = 0; j < field->count; j++)
+	{
+	  /* A single value for a pair applies to both modes.  */
+	  const char *str = values[MIN (j, nvalues - 1)];
+	  char *end;
+	  unsigned long value = strtoul (str, &end, 10);
+	  if (*end != '\0' || value > 0xffff / (field->insns_p ? 4 : 1))
+	    return false;
+	  dest[j] = field->insns_p ? COSTS_N_INSNS (value) : value;
+	}
+      return true;
+    }
+
+  return false;
+}
+
+/* Parse one line of the tuning description file FILENAME, updating INFO.
+   LINE, the LINENO'th line, has already had comments and punctuation
+   replaced by spaces, so it is a sequence of keys each followed by one or
+   two values.  Keys start with a letter; values are numbers, "true" or
+   "false".  Report each malformed entry.  */
+
+static void
+riscv_parse_tune_line (char *line, const char *filename, unsigned int lineno,
+		       struct riscv_tune_info *info)
+{
+  const char *key = NULL;
+  char *values[2];
+  unsigned int nvalues = 0;
+  bool ok = true;
+
+  for (char *tok = strtok (line, " \t\n\r"); ; tok = strtok (NULL, " \t\n\r"))
+    {
+      bool key_p = (tok != NULL
+		    && ISALPHA (tok[0])
+		    && strcmp (tok, "true") != 0
+		    && strcmp (tok, "false") != 0);
+
+      /* A new key or the end of the line completes the previous entry.  */
+      if ((tok == NULL || key_p) && key != NULL)
+	{
+	  if (ok && !riscv_parse_tune_entry (key, values, nvalues, info))
+	    ok = false;
+	  if (!ok)
+	    error ("%s:%u: invalid tuning description entry %qs",
+		   filename, lineno, key);
+	  key = NULL;
+	}
+      if (tok == NULL)
+	break;
+
+      if (key_p)
+	{
+	  key = tok;
+	  nvalues = 0;
+	  ok = true;
+	}
+      else if (key == NULL)
+	error ("%s:%u: value %qs does not follow a key", filename, lineno,
+	       tok);
+      else if (nvalues == ARRAY_SIZE (values))
+	ok = false;
+      else
+	values[nvalues++] = tok;
+    }
+}
+
+/* Initialize INFO from BASE and the tuning description in FILENAME.
+
+   The file gives fields as a key followed by one value or, for costs that
+   differ between single and double precision (or SImode and DImode), two.
+   Keys are the riscv_tune_info field names; costs are in instructions.
+   A line can hold any number of fields.  '#' starts a comment.  Quotes,
+   colons, commas, '=', braces and brackets are ignored, so both
+   "fp_add = 4 5" and a JSON object such as {"fp_add": [4, 5],
+   "int_mul": 3} are accepted.  Fields not mentioned keep BASE's value.  */
+
+static void
+riscv_read_tune_file (const char *filename,
+		      const struct riscv_tune_info *base,
+		      struct riscv_tune_info *info)
+{
+  *info = *base;
+
+  FILE *file = fopen (filename, "r");
+  if (file == NULL)
+    {
+      error ("cannot open tuning description %qs: %m", filename);
+      return;
+    }
+
+  char line[256];
+  unsigned int lineno = 0;
+  while (fgets (line, sizeof line, file))
+    {
+      lineno++;
+
+      /* Don't parse a line in pieces.  */
+      if (strchr (line, '\n') == NULL && !feof (file))
+	{
+	  error ("%s:%u: line too long in tuning description", filename,
+		 lineno);
+	  int c;
+	  while ((c = getc (file)) != EOF && c != '\n')
+	    ;
+	  continue;
+	}
+
+      if (char *comment = strchr (line, '#'))
+	*comment = '\0';
+      for (char *p = line; *p; p++)
+	if (strchr ("{}[]\":,=", *p))
+	  *p = ' ';
+
+      riscv_parse_tune_line (line, filename, lineno, info);
+    }
+
+  fclose (file);
+}
+
 /* Return the riscv_cpu_info entry for the given name string.  */
 
 static const struct riscv_cpu_info *
 riscv_parse_cpu (const char *cpu_string)
 {
+  if (strncmp (cpu_string, RISCV_TUNE_FILE_PREFIX,
+	       strlen (RISCV_TUNE_FILE_PREFIX)) == 0)
+    {
+      riscv_read_tune_file (cpu_string + strlen (RISCV_TUNE_FILE_PREFIX),
+			    riscv_parse_cpu (RISCV_TUNE_STRING_DEFAULT)->tune_info,
+			    &riscv_file_tune_info);
+      return &riscv_file_cpu_info;
+    }
+
   for (unsigned i = 0; i < ARRAY_SIZE (riscv_cpu_info_table); i++)
     if (strcmp (riscv_cpu_info_table[i].name, cpu_string) == 0)
       return riscv_cpu_info_table + i;
@@ -2752,21 +2953,49 @@ riscv_memmodel_needs_amo_acquire (enum memmodel model)
     }
 }
 
-/* Return true if a FENCE should be emitted to before a memory access to
-   implement the release portion of memory model MODEL.  */
+/* Return true if the .RL suffix should be added to an AMO to implement the
+   release portion of memory model MODEL.  The legacy __sync models use a
+   leading FENCE instead; see riscv_memmodel_needs_release_fence.  */
 
 static bool
-riscv_memmodel_needs_release_fence (enum memmodel model)
+riscv_memmodel_needs_amo_release (enum memmodel model)
 {
   switch (model)
     {
       case MEMMODEL_ACQ_REL:
       case MEMMODEL_SEQ_CST:
-      case MEMMODEL_SYNC_SEQ_CST:
       case MEMMODEL_RELEASE:
+	return true;
+
+      case MEMMODEL_SYNC_SEQ_CST:
+      case MEMMODEL_SYNC_RELEASE:
+      case MEMMODEL_ACQUIRE:
+      case MEMMODEL_CONSUME:
+      case MEMMODEL_SYNC_ACQUIRE:
+      case MEMMODEL_RELAXED:
+	return false;
+
+      default:
+	gcc_unreachable ();
+    }
+}
+
+/* Return true if a FENCE should be emitted to before a memory access to
+   implement the release portion of memory model MODEL.  Only the legacy
+   __sync models need one, since they also order device I/O.  */
+
+static bool
+riscv_memmodel_needs_release_fence (enum memmodel model)
+{
+  switch (model)
+    {
+      case MEMMODEL_SYNC_SEQ_CST:
       case MEMMODEL_SYNC_RELEASE:
 	return true;
 
+      case MEMMODEL_ACQ_REL:
+      case MEMMODEL_SEQ_CST:
+      case MEMMODEL_RELEASE:
       case MEMMODEL_ACQUIRE:
       case MEMMODEL_CONSUME:
       case MEMMODEL_SYNC_ACQUIRE:
@@ -2778,6 +3007,36 @@ riscv_memmodel_needs_release_fence (enum memmodel model)
     }
 }
 
+/* Return the FENCE instruction that implements a standalone thread fence
+   for memory model operand MODEL_RTX, using the weakest predecessor and
+   successor sets that are sufficient.  */
+
+const char *
+riscv_output_fence (rtx model_rtx)
+{
+  enum memmodel model = (enum memmodel) INTVAL (model_rtx);
+
+  if (is_mm_sync (model))
+    return "fence\tiorw,iorw";
+
+  switch (model)
+    {
+      case MEMMODEL_ACQUIRE:
+      case MEMMODEL_CONSUME:
+	return "fence\tr,rw";
+
+      case MEMMODEL_RELEASE:
+	return "fence\trw,w";
+
+      case MEMMODEL_ACQ_REL:
+      case MEMMODEL_SEQ_CST:
+	return "fence\trw,rw";
+
+      default:
+	gcc_unreachable ();
+    }
+}
+
 /* Implement TARGET_PRINT_OPERAND.  The RISCV-specific operand codes are:
 
    'h'	Print the high-part relocation associated with OP, after stripping
@@ -2785,6 +3044,8 @@ riscv_memmodel_needs_release_fence (enum memmodel model)
    'R'	Print the low-part relocation associated with OP.
    'C'	Print the integer branch condition for comparison OP.
    'A'	Print the atomic operation suffix for memory model OP.
+   'I'	Print the LR suffix for memory model OP.
+   'J'	Print the SC suffix for memory model OP.
    'F'	Print a FENCE if the memory model requires a release.
    'z'	Print x0 if OP is zero, otherwise print OP normally.  */
 
@@ -2812,8 +3073,47 @@ riscv_print_operand (FILE *file, rtx op, int letter)
       break;
 
     case 'A':
-      if (riscv_memmodel_needs_amo_acquire ((enum memmodel) INTVAL (op)))
-	fputs (".aq", file);
+      {
+	enum memmodel model = (enum memmodel) INTVAL (op);
+	bool acquire = riscv_memmodel_needs_amo_acquire (model);
+	bool release = riscv_memmodel_needs_amo_release (model);
+	if (acquire && release)
+	  fputs (".aqrl", file);
+	else if (acquire)
+	  fputs (".aq", file);
+	else if (release)
+	  fputs (".rl", file);
+      }
+      break;
+
+    case 'I':
+      {
+	/* A sequentially consistent LR/SC sequence needs the LR to be
+	   ordered after prior SCs as well.  */
+	enum memmodel model = memmodel_base (INTVAL (op));
+	if (model == MEMMODEL_SEQ_CST)
+	  fputs (".aqrl", file);
+	else if (riscv_memmodel_needs_amo_acquire (model))
+	  fputs (".aq", file);
+      }
+      break;
+
+    case 'J':
+      {
+	/* The legacy __sync operations are full barriers, so later
+	   accesses must not be performed before the SC either.  */
+	enum memmodel model = (enum memmodel) INTVAL (op);
+	bool acquire = (is_mm_sync (model)
+			&& riscv_memmodel_needs_amo_acquire (model));
+	bool release
+	  = riscv_memmodel_needs_amo_release (memmodel_base (INTVAL (op)));
+	if (acquire && release)
+	  fputs (".aqrl", file);
+	else if (acquire)
+	  fputs (".aq", file);
+	else if (release)
+	  fputs (".rl", file);
+      }
       break;
 
     case 'F':
@@ -4022,6 +4322,91 @@ riscv_cannot_copy_insn_p (rtx_insn *insn)
   return recog_memoized (insn) >= 0 && get_attr_cannot_copy (insn);
 }
 
+/* Return the memory model of a thread fence that orders everything that
+   fences for models A and B order between them.  */
+
+static enum memmodel
+riscv_merge_fence_models (enum memmodel a, enum memmodel b)
+{
+  if (is_mm_sync (a) || is_mm_sync (b))
+    return MEMMODEL_SYNC_SEQ_CST;
+
+  if (is_mm_seq_cst (a) || is_mm_seq_cst (b))
+    return MEMMODEL_SEQ_CST;
+
+  if (is_mm_consume (a))
+    a = MEMMODEL_ACQUIRE;
+  if (is_mm_consume (b))
+    b = MEMMODEL_ACQUIRE;
+
+  return a == b ? a : MEMMODEL_ACQ_REL;
+}
+
+/* Return true if INSN might access memory or otherwise be ordered by a
+   FENCE.  */
+
+static bool
+riscv_insn_ordered_by_fence_p (rtx_insn *insn)
+{
+  if (CALL_P (insn) || JUMP_P (insn) || volatile_insn_p (PATTERN (insn)))
+    return true;
+
+  subrtx_iterator::array_type array;
+  FOR_EACH_SUBRTX (iter, array, PATTERN (insn), NONCONST)
+    if (MEM_P (*iter))
+      return true;
+
+  return false;
+}
+
+/* Merge thread fences that are separated only by instructions that do not
+   access memory into a single fence whose predecessor and successor sets
+   are the union of the originals.  The sequentially consistent atomic load
+   expansion (FENCE; load; FENCE) otherwise leaves back-to-back fences
+   whenever such loads are adjacent, or follow another fence.  */
+
+static void
+riscv_merge_fences (void)
+{
+  rtx_insn *insn, *prev_fence = NULL;
+
+  for (insn = get_insns (); insn; insn = NEXT_INSN (insn))
+    {
+      if (!NONDEBUG_INSN_P (insn))
+	{
+	  if (LABEL_P (insn) || BARRIER_P (insn))
+	    prev_fence = NULL;
+	  continue;
+	}
+
+      if (recog_memoized (insn) == CODE_FOR_mem_thread_fence_1)
+	{
+	  if (prev_fence)
+	    {
+	      rtx *prev_model = &XVECEXP (PATTERN (prev_fence), 0, 1);
+	      rtx *model = &XVECEXP (PATTERN (insn), 0, 1);
+	      enum memmodel merged
+		= riscv_merge_fence_models ((enum memmodel) INTVAL (*prev_model),
+					    (enum memmodel) INTVAL (*model));
+	      *model = GEN_INT (merged);
+	      delete_insn (prev_fence);
+	    }
+	  prev_fence = insn;
+	}
+      else if (riscv_insn_ordered_by_fence_p (insn))
+	prev_fence = NULL;
+    }
+}
+
+/* Implement TARGET_MACHINE_DEPENDENT_REORG.  */
+
+static void
+riscv_reorg (void)
+{
+  if (optimize > 0)
+    riscv_merge_fences ();
+}
+
 /* Initialize the GCC target structure.  */
 #undef TARGET_ASM_ALIGNED_HI_OP
 #define TARGET_ASM_ALIGNED_HI_OP "\t.half\t"
@@ -4140,6 +4525,9 @@ riscv_cannot_copy_insn_p (rtx_insn *insn)
 #undef TARGET_CANNOT_COPY_INSN_P
 #define TARGET_CANNOT_COPY_INSN_P riscv_cannot_copy_insn_p
 
+#undef TARGET_MACHINE_DEPENDENT_REORG
+#define TARGET_MACHINE_DEPENDENT_REORG riscv_reorg
+
 #undef TARGET_ATOMIC_ASSIGN_EXPAND_FENV
 #define TARGET_ATOMIC_ASSIGN_EXPAND_FENV riscv_atomic_assign_expand_fenv
 
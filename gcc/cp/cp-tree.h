@@ -5877,6 +5877,7 @@ extern tree begin_function_body			(void);
 extern void finish_function_body		(tree);
 extern tree outer_curly_brace_block		(tree);
 extern tree finish_function			(int);
+extern void genericize_deferred_fns		(void);
 extern tree grokmethod				(cp_decl_specifier_seq *, const cp_declarator *, tree);
 extern void maybe_register_incomplete_var	(tree);
 extern void maybe_commonize_var			(tree);
@@ -6901,6 +6902,7 @@ extern tree merge_exception_specifiers		(tree, tree);
 /* in mangle.c */
 extern bool maybe_remove_implicit_alias		(tree);
 extern void init_mangle				(void);
+extern void clear_mangled_fragments		(void);
 extern void mangle_decl				(tree);
 extern const char *mangle_type_string		(tree);
 extern tree mangle_typeinfo_for_type		(tree);
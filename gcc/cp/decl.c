@@ -15503,6 +15503,98 @@ maybe_save_function_definition (tree fun)
     register_constexpr_fundef (fun, DECL_SAVED_TREE (fun));
 }
 
+/* Inline functions whose genericization finish_function has put off
+   until the end of the translation unit (-fdefer-inline-functions).  */
+
+static GTY(()) vec<tree, va_gc> *deferred_genericize_fns;
+
+/* Return true if genericizing FNDECL, whose body has just been parsed,
+   can wait until we know whether it is used at all.  Anything that the
+   back end might reach without the front end marking it used, or whose
+   body is copied as soon as it is complete, is genericized at once.  */
+
+static bool
+defer_genericize_p (tree fndecl)
+{
+  return (flag_defer_inline_functions
+	  && DECL_DECLARED_INLINE_P (fndecl)
+	  && !TREE_USED (fndecl)
+	  && !DECL_PRESERVE_P (fndecl)
+	  && !DECL_ARTIFICIAL (fndecl)
+	  && !DECL_TEMPLATE_INFO (fndecl)
+	  && !DECL_VIRTUAL_P (fndecl)
+	  && !DECL_MAYBE_IN_CHARGE_CONSTRUCTOR_P (fndecl)
+	  && !DECL_MAYBE_IN_CHARGE_DESTRUCTOR_P (fndecl)
+	  && !DECL_STATIC_CONSTRUCTOR (fndecl)
+	  && !DECL_STATIC_DESTRUCTOR (fndecl)
+	  && !LAMBDA_FUNCTION_P (fndecl)
+	  && !decl_function_context (fndecl));
+}
+
+/* Genericize FNDECL, which must be current_function_decl, and drop the
+   per-function data that was only kept for that.  */
+
+static void
+genericize_function (tree fndecl)
+{
+  struct language_function *f = DECL_SAVED_FUNCTION_DATA (fndecl);
+  cp_genericize (fndecl);
+  /* Clear out the bits we don't need.  */
+  f->x_current_class_ptr = NULL;
+  f->x_current_class_ref = NULL;
+  f->x_eh_spec_block = NULL;
+  f->x_in_charge_parm = NULL;
+  f->x_vtt_parm = NULL;
+  f->x_return_value = NULL;
+  f->bindings = NULL;
+  f->extern_decl_map = NULL;
+  f->infinite_loops = NULL;
+}
+
+/* Return true if the deferred inline function FNDECL may be compiled,
+   either because it has been used or because the back end must emit
+   it anyway.  */
+
+static bool
+deferred_fn_used_p (tree fndecl)
+{
+  if (TREE_USED (fndecl))
+    return true;
+  cgraph_node *node = cgraph_node::get (fndecl);
+  return node && (node->needed_p () || node->referred_to_p ());
+}
+
+/* Called at the end of the translation unit.  Genericize the inline
+   functions deferred by finish_function that turned out to be used.
+   The others are never handed to the gimplifier, so their bodies can
+   stay as the parser left them.  */
+
+void
+genericize_deferred_fns (void)
+{
+  bool reconsider;
+  unsigned ix;
+  tree fndecl;
+
+  /* Genericizing one function may use another.  */
+  do
+    {
+      reconsider = false;
+      FOR_EACH_VEC_SAFE_ELT (deferred_genericize_fns, ix, fndecl)
+	if (fndecl && deferred_fn_used_p (fndecl))
+	  {
+	    (*deferred_genericize_fns)[ix] = NULL_TREE;
+	    push_cfun (DECL_STRUCT_FUNCTION (fndecl));
+	    genericize_function (fndecl);
+	    pop_cfun ();
+	    reconsider = true;
+	  }
+    }
+  while (reconsider);
+
+  vec_free (deferred_genericize_fns);
+}
+
 /* Finish up a function declaration and compile that function
    all the way to assembler language output.  The free the storage
    for the function definition.
@@ -15745,21 +15837,14 @@ finish_function (int flags)
       && !DECL_CLONED_FUNCTION_P (fndecl))
     do_warn_unused_parameter (fndecl);
 
-  /* Genericize before inlining.  */
+  /* Genericize before inlining, unless that can wait until we know
+     whether FNDECL is used.  */
   if (!processing_template_decl)
     {
-      struct language_function *f = DECL_SAVED_FUNCTION_DATA (fndecl);
-      cp_genericize (fndecl);
-      /* Clear out the bits we don't need.  */
-      f->x_current_class_ptr = NULL;
-      f->x_current_class_ref = NULL;
-      f->x_eh_spec_block = NULL;
-      f->x_in_charge_parm = NULL;
-      f->x_vtt_parm = NULL;
-      f->x_return_value = NULL;
-      f->bindings = NULL;
-      f->extern_decl_map = NULL;
-      f->infinite_loops = NULL;
+      if (defer_genericize_p (fndecl))
+	vec_safe_push (deferred_genericize_fns, fndecl);
+      else
+	genericize_function (fndecl);
     }
   /* Clear out the bits we don't need.  */
   local_names = NULL;
@@ -2669,6 +2669,9 @@ bt_reset_linkage_2 (binding_entry b, void */*data*/)
 void
 reset_type_linkage (tree type)
 {
+  /* The manglings remembered for TYPE and its members still use the
+     unnamed form.  */
+  clear_mangled_fragments ();
   reset_type_linkage_1 (type);
   reset_type_linkage_2 (type);
 }
@@ -4826,6 +4829,8 @@ c_parse_final_cleanups (void)
       vtv_build_vtable_verify_fndecl ();
     }
 
+  genericize_deferred_fns ();
+
   perform_deferred_noexcept_checks ();
 
   finish_repo ();
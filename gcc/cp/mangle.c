@@ -193,6 +193,7 @@ static void write_unscoped_name (const tree);
 static void write_unscoped_template_name (const tree);
 static void write_nested_name (const tree);
 static void write_prefix (const tree);
+static void write_prefix_1 (const tree);
 static void write_template_prefix (const tree);
 static void write_unqualified_name (tree);
 static void write_conversion_operator_name (const tree);
@@ -1086,6 +1087,151 @@ write_nested_name (const tree decl)
   write_char ('E');
 }
 
+/* Some productions are written again and again at the start of a
+   mangling: the <type> of a class for its typeinfo object and name, its
+   vtable and VTT, and the <prefix> naming the class or namespace of
+   every member.  Written where there are no substitution candidates yet,
+   their mangling does not depend on the rest of the name, so it is
+   remembered together with the candidates it adds and the warnings it
+   calls for.  Entries are keyed by the node itself, not its canonical
+   type, as a typedef can carry different ABI tags, and by the ABI
+   version being mangled for.  They live as long as the node does.  */
+
+struct GTY((for_user)) mangled_fragment {
+  tree node;
+  int abi_version;
+  /* True for a <prefix>, false for a <type>.  */
+  bool prefix_p;
+  bool need_abi_warning;
+  bool need_cxx1z_warning;
+  unsigned length;
+  const char *chars;
+  /* The substitution candidates added by the fragment, in order.  */
+  vec<tree, va_gc> *substitutions;
+};
+
+struct mangled_fragment_hasher : ggc_cache_ptr_hash<mangled_fragment>
+{
+  static hashval_t hash (mangled_fragment *);
+  static bool equal (mangled_fragment *, mangled_fragment *);
+
+  static int
+  keep_cache_entry (mangled_fragment *&e)
+  {
+    return ggc_marked_p (e->node);
+  }
+};
+
+static GTY((cache)) hash_table<mangled_fragment_hasher> *mangled_fragments;
+
+hashval_t
+mangled_fragment_hasher::hash (mangled_fragment *e)
+{
+  return iterative_hash_hashval_t (DECL_P (e->node)
+				   ? DECL_UID (e->node) : TYPE_UID (e->node),
+				   e->abi_version * 2 + e->prefix_p);
+}
+
+bool
+mangled_fragment_hasher::equal (mangled_fragment *e1, mangled_fragment *e2)
+{
+  return (e1->node == e2->node
+	  && e1->abi_version == e2->abi_version
+	  && e1->prefix_p == e2->prefix_p);
+}
+
+/* Forget all the remembered fragments.  This is called when a class
+   that had no name for linkage purposes is given one, which changes the
+   mangling of it and of everything in its scope.  */
+
+void
+clear_mangled_fragments (void)
+{
+  if (mangled_fragments)
+    mangled_fragments->empty ();
+}
+
+/* Return true if the mangling of NODE, a namespace or a class, can be
+   remembered.  The mangling of an unnamed class and of what it encloses
+   changes if a typedef later names it, so leave them alone.  */
+
+static bool
+fragment_cacheable_p (tree node)
+{
+  if (TREE_CODE (node) != NAMESPACE_DECL && !CLASS_TYPE_P (node))
+    return false;
+
+  for (tree t = node; t && TREE_CODE (t) != NAMESPACE_DECL;
+       t = TYPE_P (t) ? TYPE_CONTEXT (t) : DECL_CONTEXT (t))
+    if (TYPE_P (t) && TYPE_UNNAMED_P (t))
+      return false;
+
+  return true;
+}
+
+/* Write the <prefix> for NODE if PREFIX_P, or else its <type>, where
+   there are no substitution candidates yet, reusing an earlier mangling
+   of NODE from the same position if there is one.  */
+
+static void
+write_cached_fragment (tree node, bool prefix_p)
+{
+  gcc_checking_assert (vec_safe_is_empty (G.substitutions)
+		       && G.parm_depth == 0);
+
+  if (!fragment_cacheable_p (node))
+    {
+      if (prefix_p)
+	write_prefix_1 (node);
+      else
+	write_type (node);
+      return;
+    }
+
+  if (mangled_fragments == NULL)
+    mangled_fragments = hash_table<mangled_fragment_hasher>::create_ggc (127);
+
+  mangled_fragment probe;
+  probe.node = node;
+  probe.abi_version = flag_abi_version;
+  probe.prefix_p = prefix_p;
+  mangled_fragment *e = mangled_fragments->find (&probe);
+  if (e)
+    {
+      write_chars (e->chars, e->length);
+      vec_safe_splice (G.substitutions, e->substitutions);
+      G.need_abi_warning |= e->need_abi_warning;
+      G.need_cxx1z_warning |= e->need_cxx1z_warning;
+      return;
+    }
+
+  bool need_abi_warning = G.need_abi_warning;
+  bool need_cxx1z_warning = G.need_cxx1z_warning;
+  int start = obstack_object_size (mangle_obstack);
+
+  G.need_abi_warning = false;
+  G.need_cxx1z_warning = false;
+  if (prefix_p)
+    write_prefix_1 (node);
+  else
+    write_type (node);
+
+  e = ggc_alloc<mangled_fragment> ();
+  *e = probe;
+  e->need_abi_warning = G.need_abi_warning;
+  e->need_cxx1z_warning = G.need_cxx1z_warning;
+  e->length = obstack_object_size (mangle_obstack) - start;
+  e->chars = ggc_alloc_string ((const char *) obstack_base (mangle_obstack)
+			       + start, e->length);
+  e->substitutions = vec_safe_copy (G.substitutions);
+  /* Writing NODE may have added entries for its own components, so the
+     slot is only looked up now.  */
+  *mangled_fragments->find_slot (&probe, INSERT) = e;
+
+  G.need_abi_warning |= need_abi_warning;
+  G.need_cxx1z_warning |= need_cxx1z_warning;
+}
+
 /* <prefix> ::= <prefix> <unqualified-name>
 	    ::= <template-param>
 	    ::= <template-prefix> <template-args>
@@ -1096,10 +1242,6 @@ write_nested_name (const tree decl)
 static void
 write_prefix (const tree node)
 {
-  tree decl;
-  /* Non-NULL if NODE represents a template-id.  */
-  tree template_info = NULL;
-
   if (node == NULL
       || node == global_namespace)
     return;
@@ -1112,6 +1254,23 @@ write_prefix (const tree node)
       return;
     }
 
+  if (vec_safe_is_empty (G.substitutions)
+      && G.parm_depth == 0)
+    write_cached_fragment (node, /*prefix_p=*/true);
+  else
+    write_prefix_1 (node);
+}
+
+/* Write the <prefix> for NODE, which is neither empty nor a
+   <decltype>.  */
+
+static void
+write_prefix_1 (const tree node)
+{
+  tree decl;
+  /* Non-NULL if NODE represents a template-id.  */
+  tree template_info = NULL;
+
   if (find_substitution (node))
     return;
 
@@ -3756,7 +3915,7 @@ mangle_decl_string (const tree decl)
   start_mangling (decl);
 
   if (TREE_CODE (decl) == TYPE_DECL)
-    write_type (TREE_TYPE (decl));
+    write_cached_fragment (TREE_TYPE (decl), /*prefix_p=*/false);
   else
     write_mangled_name (decl, true);
 
@@ -3944,7 +4103,7 @@ mangle_type_string (const tree type)
   const char *result;
 
   start_mangling (type);
-  write_type (type);
+  write_cached_fragment (type, /*prefix_p=*/false);
   result = finish_mangling ();
   if (DEBUG_MANGLE)
     fprintf (stderr, "mangle_type_string = '%s'\n\n", result);
@@ -3969,7 +4128,7 @@ mangle_special_for_type (const tree type, const char *code)
   write_string (code);
 
   /* Add the type.  */
-  write_type (type);
+  write_cached_fragment (type, /*prefix_p=*/false);
   result = finish_mangling_get_identifier ();
 
   if (DEBUG_MANGLE)
@@ -2179,6 +2179,77 @@ find_binding (cp_binding_level *scope, cxx_binding *binding)
   return (cxx_binding *)0;
 }
 
+/* A name declared in many namespaces has a long chain of namespace
+   bindings, which find_binding would walk over and over, mostly to find
+   that the name is not bound in the scope at hand.  Past the first
+   BINDING_INDEX_MIN_CHAIN links we look the binding up in a hash table
+   indexed by scope and name instead.  An entry records the binding
+   found, or NULL if there is none.  As bindings are only ever added to
+   the chains, binding_for_name keeps the entries up to date.  */
+
+#define BINDING_INDEX_MIN_CHAIN 8
+
+struct GTY((for_user)) binding_index_entry {
+  tree name;
+  cp_binding_level *scope;
+  cxx_binding *binding;
+};
+
+struct binding_index_hasher : ggc_ptr_hash<binding_index_entry>
+{
+  static hashval_t hash (binding_index_entry *);
+  static bool equal (binding_index_entry *, binding_index_entry *);
+};
+
+static GTY((deletable)) hash_table<binding_index_hasher> *binding_index;
+
+hashval_t
+binding_index_hasher::hash (binding_index_entry *e)
+{
+  return iterative_hash_hashval_t (IDENTIFIER_HASH_VALUE (e->name),
+				   htab_hash_pointer (e->scope));
+}
+
+bool
+binding_index_hasher::equal (binding_index_entry *e1,
+			     binding_index_entry *e2)
+{
+  return e1->name == e2->name && e1->scope == e2->scope;
+}
+
+/* Return the binding for NAME in SCOPE from the chain of namespace
+   bindings starting at BINDING, if any.  */
+
+static cxx_binding *
+find_namespace_binding (cp_binding_level *scope, tree name,
+			cxx_binding *binding)
+{
+  for (int n = 0; n < BINDING_INDEX_MIN_CHAIN; n++)
+    {
+      if (binding == NULL)
+	return NULL;
+      if (binding->scope == scope)
+	return binding;
+      binding = binding->previous;
+    }
+  if (binding == NULL)
+    return NULL;
+
+  if (binding_index == NULL)
+    binding_index = hash_table<binding_index_hasher>::create_ggc (1021);
+
+  binding_index_entry probe = { name, scope, NULL };
+  binding_index_entry **slot = binding_index->find_slot (&probe, INSERT);
+  if (*slot == NULL)
+    {
+      binding_index_entry *e = ggc_alloc<binding_index_entry> ();
+      *e = probe;
+      e->binding = find_binding (scope, binding);
+      *slot = e;
+    }
+  return (*slot)->binding;
+}
+
 /* Return the binding for NAME in SCOPE, if any.  Otherwise, return NULL.  */
 
 static inline cxx_binding *
@@ -2190,7 +2261,7 @@ cp_binding_level_find_binding_for_name (cp_binding_level *scope, tree name)
       /* Fold-in case where NAME is used only once.  */
       if (scope == b->scope && b->previous == NULL)
 	return b;
-      return find_binding (scope, b);
+      return find_namespace_binding (scope, name, b);
     }
   return NULL;
 }
@@ -2213,6 +2284,12 @@ binding_for_name (cp_binding_level *scope, tree name)
   result->is_local = false;
   result->value_is_inherited = false;
   IDENTIFIER_NAMESPACE_BINDINGS (name) = result;
+  if (binding_index)
+    {
+      binding_index_entry probe = { name, scope, NULL };
+      if (binding_index_entry *e = binding_index->find (&probe))
+	e->binding = result;
+    }
   return result;
 }
 
@@ -4700,11 +4777,11 @@ lookup_using_namespace (tree name, struct scope_binding *val,
 /* Returns true iff VEC contains TARGET.  */
 
 static bool
-tree_vec_contains (vec<tree, va_gc> *vec, tree target)
+tree_vec_contains (vec<tree> &vec, tree target)
 {
   unsigned int i;
   tree elt;
-  FOR_EACH_VEC_SAFE_ELT (vec,i,elt)
+  FOR_EACH_VEC_ELT (vec,i,elt)
     if (elt == target)
       return true;
   return false;
@@ -4720,12 +4797,12 @@ qualified_lookup_using_namespace (tree name, tree scope,
 				  struct scope_binding *result, int flags)
 {
   /* Maintain a list of namespaces visited...  */
-  vec<tree, va_gc> *seen = NULL;
-  vec<tree, va_gc> *seen_inline = NULL;
+  auto_vec<tree, 16> seen;
+  auto_vec<tree, 16> seen_inline;
   /* ... and a list of namespace yet to see.  */
-  vec<tree, va_gc> *todo = NULL;
-  vec<tree, va_gc> *todo_maybe = NULL;
-  vec<tree, va_gc> *todo_inline = NULL;
+  auto_vec<tree, 16> todo;
+  auto_vec<tree, 16> todo_maybe;
+  auto_vec<tree, 16> todo_inline;
   tree usings;
   timevar_start (TV_NAME_LOOKUP);
   /* Look through namespace aliases.  */
@@ -4737,26 +4814,26 @@ qualified_lookup_using_namespace (tree name, tree scope,
      namespaces.  For each used namespace, look through its inline
      namespace set for any bindings and usings.  If no bindings are
      found, add any usings seen to the set of used namespaces.  */
-  vec_safe_push (todo, scope);
+  todo.safe_push (scope);
 
-  while (todo->length ())
+  while (todo.length ())
     {
       bool found_here;
-      scope = todo->pop ();
+      scope = todo.pop ();
       if (tree_vec_contains (seen, scope))
 	continue;
-      vec_safe_push (seen, scope);
-      vec_safe_push (todo_inline, scope);
+      seen.safe_push (scope);
+      todo_inline.safe_push (scope);
 
       found_here = false;
-      while (todo_inline->length ())
+      while (todo_inline.length ())
 	{
 	  cxx_binding *binding;
 
-	  scope = todo_inline->pop ();
+	  scope = todo_inline.pop ();
 	  if (tree_vec_contains (seen_inline, scope))
 	    continue;
-	  vec_safe_push (seen_inline, scope);
+	  seen_inline.safe_push (scope);
 
 	  binding =
 	    cp_binding_level_find_binding_for_name (NAMESPACE_LEVEL (scope), name);
@@ -4772,23 +4849,18 @@ qualified_lookup_using_namespace (tree name, tree scope,
 	    if (!TREE_INDIRECT_USING (usings))
 	      {
 		if (is_associated_namespace (scope, TREE_PURPOSE (usings)))
-		  vec_safe_push (todo_inline, TREE_PURPOSE (usings));
+		  todo_inline.safe_push (TREE_PURPOSE (usings));
 		else
-		  vec_safe_push (todo_maybe, TREE_PURPOSE (usings));
+		  todo_maybe.safe_push (TREE_PURPOSE (usings));
 	      }
 	}
 
       if (found_here)
-	vec_safe_truncate (todo_maybe, 0);
+	todo_maybe.truncate (0);
       else
-	while (vec_safe_length (todo_maybe))
-	  vec_safe_push (todo, todo_maybe->pop ());
-    }
-  vec_free (todo);
-  vec_free (todo_maybe);
-  vec_free (todo_inline);
-  vec_free (seen);
-  vec_free (seen_inline);
+	while (todo_maybe.length ())
+	  todo.safe_push (todo_maybe.pop ());
+    }
   timevar_stop (TV_NAME_LOOKUP);
   return result->value != error_mark_node;
 }
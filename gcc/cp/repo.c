@@ -30,12 +30,16 @@ along with GCC; see the file COPYING3.  If not see
 #include "cp-tree.h"
 #include "stringpool.h"
 #include "toplev.h"
+#include "version.h"
 
 static const char *extract_string (const char **);
 static const char *get_base_filename (const char *);
 static FILE *open_repo_file (const char *);
 static char *afgets (FILE *);
 static FILE *reopen_repo_file_for_write (void);
+static void init_instantiation_cache (void);
+static void finish_instantiation_cache (void);
+static int instantiation_cache_emit_p (tree);
 
 static GTY(()) vec<tree, va_gc> *pending_repo;
 static char *repo_name;
@@ -45,6 +49,31 @@ static const char *old_args, *old_dir, *old_main;
 static struct obstack temporary_obstack;
 static bool temporary_obstack_initialized_p;
 
+/* The instantiation cache named by -finstantiation-cache=.  It holds one
+   line per instantiation emitted by some translation unit, made of the
+   options key of that unit, the generation of the compilation that wrote
+   it, the assembler name and the main input file.  Only the newest
+   generation of lines for an input file counts; a compilation that
+   replaces lines but emits nothing writes "-" as the name.
+   INSTANTIATIONS_EMITTED is the set of names emitted by other units
+   compiled with our key, and INSTANTIATIONS_CLAIMED those that we emit
+   and will add to the file.  INSTANTIATION_CACHE_REPLACES_P is true if
+   the file has lines from an earlier compilation of our input.  */
+static hash_set<const char *, nofree_string_hash> *instantiations_emitted;
+static vec<const char *> instantiations_claimed;
+static char instantiation_cache_key[9];
+static char instantiation_cache_generation[40];
+static char *instantiation_cache_input;
+static bool instantiation_cache_replaces_p;
+
+/* A line of the instantiation cache written with our key.  */
+struct instantiation_cache_line
+{
+  const char *generation;
+  const char *name;
+  const char *input;
+};
+
 /* Parse a reasonable subset of shell quoting syntax.  */
 
 static const char *
@@ -159,7 +188,10 @@ init_repo (void)
   FILE *repo_file;
 
   if (! flag_use_repository)
-    return;
+    {
+      init_instantiation_cache ();
+      return;
+    }
 
   /* When a PCH file is loaded, the entire identifier table is
      replaced, with the result that IDENTIFIER_REPO_CHOSEN is cleared.
@@ -235,6 +267,9 @@ finish_repo (void)
   FILE *repo_file;
   unsigned ix;
 
+  if (!flag_use_repository)
+    finish_instantiation_cache ();
+
   if (!flag_use_repository || flag_compare_debug)
     return;
 
@@ -293,9 +328,10 @@ repo_emit_p (tree decl)
 		 maybe_clone_body.  */
 	      || DECL_ABSTRACT_ORIGIN (decl));
 
-  /* When not using the repository, emit everything.  */
+  /* When not using the repository, emit everything, unless the
+     instantiation cache says otherwise.  */
   if (!flag_use_repository)
-    return 2;
+    return instantiation_cache_emit_p (decl);
 
   /* Only template instantiations are managed by the repository.  This
      is an artificial restriction; the code in the prelinker and here
@@ -356,6 +392,209 @@ repo_emit_p (tree decl)
   return IDENTIFIER_REPO_CHOSEN (DECL_ASSEMBLER_NAME (decl)) ? 1 : ret;
 }
 
+/* Compute the key under which this translation unit records its
+   instantiations in the cache: a checksum of the compiler version and
+   of the options it was run with, less those that only name outputs.  */
+
+static void
+compute_instantiation_cache_key (void)
+{
+  const char *p = getenv ("COLLECT_GCC_OPTIONS");
+  unsigned chksum = crc32_string (0, version_string);
+
+  while (p && *p)
+    {
+      const char *q = extract_string (&p);
+
+      if (strcmp (q, "-o") == 0
+	  || strcmp (q, "-MF") == 0
+	  || strcmp (q, "-MT") == 0
+	  || strcmp (q, "-MQ") == 0)
+	extract_string (&p);
+      else if (strcmp (q, "-c") != 0
+	       && strcmp (q, "-MD") != 0
+	       && strcmp (q, "-MMD") != 0)
+	chksum = crc32_string (chksum, q);
+    }
+
+  sprintf (instantiation_cache_key, "%08x", chksum);
+}
+
+/* Read the instantiation cache, if one was requested.  */
+
+static void
+init_instantiation_cache (void)
+{
+  FILE *cache_file;
+  char *buf;
+
+  /* A PCH is not linked into anything, so it cannot provide
+     instantiations to others, and must not rely on them either.  The
+     second compilation of -fcompare-debug would see the names that the
+     first one has just added.  */
+  if (!instantiation_cache_file || pch_file || flag_compare_debug)
+    return;
+
+  if (!temporary_obstack_initialized_p)
+    {
+      gcc_obstack_init (&temporary_obstack);
+      temporary_obstack_initialized_p = true;
+    }
+
+  compute_instantiation_cache_key ();
+  sprintf (instantiation_cache_generation, "%lx.%lx",
+	   (unsigned long) time (NULL), (unsigned long) getpid ());
+  instantiation_cache_input = lrealpath (main_input_filename);
+  instantiations_emitted = new hash_set<const char *, nofree_string_hash>;
+
+  cache_file = fopen (instantiation_cache_file, "r");
+  if (cache_file == 0)
+    return;
+
+  /* Keep the lines read with our key on the obstack; they live as long
+     as the compilation does.  Lines are appended as compilations
+     finish, so the last generation seen for an input is the newest.  */
+  auto_vec<instantiation_cache_line> lines;
+  hash_map<const char *, const char *,
+	   simple_hashmap_traits<nofree_string_hash, const char *> > newest;
+  while ((buf = afgets (cache_file)))
+    {
+      instantiation_cache_line line;
+      char *p, *q;
+
+      if (strncmp (buf, instantiation_cache_key, 8) == 0
+	  && buf[8] == ' '
+	  && (p = strchr (buf + 9, ' ')) != NULL
+	  && (q = strchr (p + 1, ' ')) != NULL)
+	{
+	  *p = *q = '\0';
+	  line.generation = buf + 9;
+	  line.name = p + 1;
+	  line.input = q + 1;
+	  lines.safe_push (line);
+	  newest.put (line.input, line.generation);
+	}
+      else
+	obstack_free (&temporary_obstack, buf);
+    }
+  fclose (cache_file);
+
+  /* What an earlier compilation of this very file recorded is of no use:
+     it is being replaced.  */
+  unsigned ix;
+  instantiation_cache_line *line;
+  FOR_EACH_VEC_ELT (lines, ix, line)
+    if (strcmp (line->input, instantiation_cache_input) == 0)
+      instantiation_cache_replaces_p = true;
+    else if (strcmp (line->generation, *newest.get (line->input)) == 0
+	     && strcmp (line->name, "-") != 0)
+      instantiations_emitted->add (line->name);
+}
+
+/* Append the instantiations that this translation unit emits to the
+   cache.  They are written with a single write to the file opened for
+   appending, so that concurrent compilations don't interleave.  */
+
+static void
+finish_instantiation_cache (void)
+{
+  const char *name;
+  unsigned ix;
+  char *buf;
+  size_t len;
+  int fd;
+
+  if (!instantiations_emitted
+      || (instantiations_claimed.is_empty ()
+	  && !instantiation_cache_replaces_p)
+      || seen_error ())
+    return;
+
+  /* Supersede the lines of an earlier compilation even when we emit
+     nothing.  */
+  if (instantiations_claimed.is_empty ())
+    instantiations_claimed.safe_push ("-");
+
+  FOR_EACH_VEC_ELT (instantiations_claimed, ix, name)
+    {
+      obstack_grow (&temporary_obstack, instantiation_cache_key, 8);
+      obstack_1grow (&temporary_obstack, ' ');
+      obstack_grow (&temporary_obstack, instantiation_cache_generation,
+		    strlen (instantiation_cache_generation));
+      obstack_1grow (&temporary_obstack, ' ');
+      obstack_grow (&temporary_obstack, name, strlen (name));
+      obstack_1grow (&temporary_obstack, ' ');
+      obstack_grow (&temporary_obstack, instantiation_cache_input,
+		    strlen (instantiation_cache_input));
+      obstack_1grow (&temporary_obstack, '\n');
+    }
+  len = obstack_object_size (&temporary_obstack);
+  buf = (char *) obstack_finish (&temporary_obstack);
+
+  fd = open (instantiation_cache_file, O_WRONLY | O_APPEND | O_CREAT, 0666);
+  if (fd < 0 || write (fd, buf, len) != (ssize_t) len)
+    error ("can%'t write instantiation cache %qs: %m",
+	   instantiation_cache_file);
+  if (fd >= 0)
+    close (fd);
+
+  obstack_free (&temporary_obstack, buf);
+  instantiations_claimed.release ();
+}
+
+/* DECL is a public FUNCTION_DECL or VAR_DECL whose definition is
+   available in this translation unit, and -frepo is not in use.
+   Returns 0 if the instantiation cache says that another translation
+   unit emits DECL, and 2 otherwise.  In the latter case DECL is claimed
+   for this translation unit and forced out, so that it really is
+   emitted here when the others rely on that.  */
+
+static int
+instantiation_cache_emit_p (tree decl)
+{
+  const char *name;
+
+  /* Only manage ordinary implicit instantiations of functions.  The
+     bodies of constexpr functions are needed for constant evaluation,
+     whoever emits them.  */
+  if (!instantiations_emitted
+      || TREE_CODE (decl) != FUNCTION_DECL
+      || !DECL_TEMPLATE_INSTANTIATION (decl)
+      || DECL_EXPLICIT_INSTANTIATION (decl)
+      || DECL_DECLARED_CONSTEXPR_P (decl))
+    return 2;
+
+  /* As for the repository, the clones of constructors and destructors
+     are what gets emitted.  DECL is emitted elsewhere only if all of
+     them are.  */
+  if (DECL_MAYBE_IN_CHARGE_CONSTRUCTOR_P (decl)
+      || DECL_MAYBE_IN_CHARGE_DESTRUCTOR_P (decl))
+    {
+      int emit_p = 0;
+      bool cloned_p = false;
+      tree clone;
+      FOR_EACH_CLONE (clone, decl)
+	{
+	  cloned_p = true;
+	  if (instantiation_cache_emit_p (clone))
+	    emit_p = 2;
+	}
+      return cloned_p ? emit_p : 2;
+    }
+
+  name = IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (decl));
+  if (instantiations_emitted->contains (name))
+    return 0;
+
+  if (!DECL_REPO_AVAILABLE_P (decl))
+    {
+      DECL_REPO_AVAILABLE_P (decl) = 1;
+      instantiations_claimed.safe_push (name);
+      mark_needed (decl);
+    }
+  return 2;
+}
+
 /* Returns true iff the prelinker has explicitly marked CLASS_TYPE for
    export from this translation unit.  */
 
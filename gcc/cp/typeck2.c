@@ -843,8 +843,14 @@ store_init_value (tree decl, tree init, vec<tree, va_gc>** cleanups, int flags)
   /* Handle aggregate NSDMI in non-constant initializers, too.  */
   value = replace_placeholders (value, decl);
 
-  /* DECL may change value; purge caches.  */
-  clear_cv_and_fold_caches ();
+  /* DECL may change value; purge caches.  Only the value of a variable
+     usable in constant expressions, or of a static one, can have been
+     folded into them, and only if DECL has already been referred to;
+     usually it has not, and keeping the caches then avoids evaluating
+     the same constant expressions over and over.  */
+  if ((decl_maybe_constant_var_p (decl) || TREE_STATIC (decl))
+      && TREE_USED (decl))
+    clear_cv_and_fold_caches ();
 
   /* If the initializer is not a constant, fill in DECL_INITIAL with
      the bits that are constant, and then return an expression that
@@ -266,6 +266,13 @@ enum lto_partition_model {
   LTO_PARTITION_MAX = 4
 };
 
+/* flag_lto_compression_algorithm initialization values.  */
+enum lto_compression_algorithm {
+  LTO_COMPRESSION_DEFAULT,
+  LTO_COMPRESSION_ZLIB,
+  LTO_COMPRESSION_ZSTD
+};
+
 /* flag_lto_linker_output initialization values.  */
 enum lto_linker_output {
   LTO_LINKER_OUTPUT_UNKNOWN,
@@ -275,6 +282,12 @@ enum lto_linker_output {
   LTO_LINKER_OUTPUT_EXEC
 };
 
+/* flag_time_report_format initialization values.  */
+enum time_report_format {
+  TIME_REPORT_FORMAT_TEXT,
+  TIME_REPORT_FORMAT_JSON
+};
+
 /* gfortran -finit-real= values.  */
 
 enum gfc_init_local_real
@@ -412,10 +412,12 @@ struct mmap_info
   void *preferred_base;
 };
 
-/* Write out the state of the compiler to F.  */
+/* Write out the state of the compiler to F.  Store in *BASE and *SIZE
+   the address and size of the memory the objects must be mapped at when
+   they are read back.  */
 
 void
-gt_pch_save (FILE *f)
+gt_pch_save (FILE *f, void **base, size_t *size)
 {
   const struct ggc_root_tab *const *rt;
   const struct ggc_root_tab *rti;
@@ -452,6 +454,8 @@ gt_pch_save (FILE *f)
   mmi.preferred_base = host_hooks.gt_pch_get_address (mmi.size, fileno (f));
 
   ggc_pch_this_base (state.d, mmi.preferred_base);
+  *base = mmi.preferred_base;
+  *size = mmi.size;
 
   state.ptrs = XNEWVEC (struct ptr_data *, state.count);
   state.ptrs_i = 0;
@@ -676,6 +680,16 @@ default_gt_pch_alloc_granularity (void)
   return getpagesize ();
 }
 
+/* Default version of HOST_HOOKS_GT_PCH_ADDRESS_AVAILABLE_P.  Assume the
+   address is available and leave it to gt_pch_use_address to tell.  */
+
+bool
+default_gt_pch_address_available_p (void *addr ATTRIBUTE_UNUSED,
+				    size_t size ATTRIBUTE_UNUSED)
+{
+  return true;
+}
+
 #if HAVE_MMAP_FILE
 /* Default version of HOST_HOOKS_GT_PCH_GET_ADDRESS when mmap is present.
    We temporarily allocate SIZE bytes, and let the kernel place the data
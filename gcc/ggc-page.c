@@ -55,6 +55,13 @@ along with GCC; see the file COPYING3.  If not see
 # define USING_MADVISE
 #endif
 
+/* With -fgc-huge-pages, the heap is mapped in regions aligned to the
+   transparent huge page size and marked with MADV_HUGEPAGE.  */
+#if defined(USING_MADVISE) && defined(MADV_HUGEPAGE)
+# define USING_HUGE_PAGES
+# define GGC_HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+#endif
+
 /* Strategy:
 
    This garbage-collecting allocator allocates objects on one of a set
@@ -401,6 +408,16 @@ static struct ggc_globals
   /* Bytes currently allocated at the end of the last collection.  */
   size_t allocated_last_gc;
 
+#ifdef USING_HUGE_PAGES
+  /* Number of regions mapped for huge pages, and the bytes in them.  */
+  unsigned long huge_regions;
+  size_t huge_bytes_mapped;
+
+  /* Bytes of free pages that release_pages kept mapped, last time it
+     ran, so as not to split huge pages.  */
+  size_t huge_bytes_kept;
+#endif
+
   /* Total amount of memory mapped.  */
   size_t bytes_mapped;
 
@@ -735,6 +752,68 @@ alloc_anon (char *pref ATTRIBUTE_UNUSED, size_t size, bool check)
   return page;
 }
 #endif
+#ifdef USING_HUGE_PAGES
+/* Allocate SIZE bytes of anonymous memory aligned to GGC_HUGE_PAGE_SIZE,
+   SIZE being a multiple of it, and ask the kernel to back them with
+   huge pages.  Return NULL on failure.  */
+
+static char *
+alloc_huge_anon (size_t size)
+{
+  char *base = alloc_anon (NULL, size + GGC_HUGE_PAGE_SIZE, false);
+  char *page;
+  size_t head;
+
+  if (base == NULL)
+    return NULL;
+
+  /* Unmap the unaligned ends of the over-sized mapping.  */
+  page = (char *) ROUND_UP ((uintptr_t) base, GGC_HUGE_PAGE_SIZE);
+  head = page - base;
+  if (head)
+    munmap (base, head);
+  if (head != GGC_HUGE_PAGE_SIZE)
+    munmap (page + size, GGC_HUGE_PAGE_SIZE - head);
+  G.bytes_mapped -= GGC_HUGE_PAGE_SIZE;
+
+  madvise (page, size, MADV_HUGEPAGE);
+  G.huge_regions++;
+  G.huge_bytes_mapped += size;
+  return page;
+}
+
+/* Narrow the run of adjacent free pages that starts at *FIRST, whose
+   predecessor in the free list is *PREV, and ends before LAST to the
+   pages that lie within whole huge pages.  Update *FIRST, *PREV, *START
+   and *LEN accordingly and return the entry that now ends the run.  */
+
+static page_entry *
+huge_page_subrun (page_entry **prev, page_entry **first, page_entry *last,
+		  char **start, size_t *len)
+{
+  char *lo = (char *) ROUND_UP ((uintptr_t) *start, GGC_HUGE_PAGE_SIZE);
+  char *hi = (char *) ROUND_DOWN ((uintptr_t) (*start + *len),
+				  GGC_HUGE_PAGE_SIZE);
+  page_entry *p = *first;
+  char *end;
+
+  while (p != last && p->page < lo)
+    {
+      *prev = p;
+      p = p->next;
+    }
+  *first = p;
+  *start = end = (p != last ? p->page : hi);
+
+  while (p != last && p->page + p->bytes <= hi)
+    {
+      end = p->page + p->bytes;
+      p = p->next;
+    }
+  *len = end - *start;
+  return p;
+}
+#endif
 #ifdef USING_MALLOC_PAGE_GROUPS
 /* Compute the index for this page into the page group.  */
 
@@ -824,6 +903,18 @@ alloc_page (unsigned order)
       struct page_entry *e, *f = G.free_pages;
       int i, entries = GGC_QUIRE_SIZE;
 
+      page = NULL;
+#ifdef USING_HUGE_PAGES
+      if (flag_gc_huge_pages)
+	{
+	  size_t size = ROUND_UP (G.pagesize * GGC_QUIRE_SIZE,
+				  GGC_HUGE_PAGE_SIZE);
+	  page = alloc_huge_anon (size);
+	  if (page != NULL)
+	    entries = size >> G.lg_pagesize;
+	}
+      if (page == NULL)
+#endif
       page = alloc_anon (NULL, G.pagesize * GGC_QUIRE_SIZE, false);
       if (page == NULL)
      	{
@@ -1020,13 +1111,19 @@ static void
 release_pages (void)
 {
 #ifdef USING_MADVISE
-  page_entry *p, *start_p;
+  page_entry *p, *start_p, *end_p;
   char *start;
   size_t len;
   size_t mapped_len;
-  page_entry *next, *prev, *newprev;
+  page_entry *next, *prev, *newprev, *run_prev;
   size_t free_unit = (GGC_QUIRE_SIZE/2) * G.pagesize;
 
+#ifdef USING_HUGE_PAGES
+  /* Releasing part of a huge page makes the kernel split it, so with
+     -fgc-huge-pages only whole huge pages are given back.  */
+  G.huge_bytes_kept = 0;
+#endif
+
   /* First free larger continuous areas to the OS.
      This allows other allocators to grab these areas if needed.
      This is only done on larger chunks to avoid fragmentation. 
@@ -1040,30 +1137,39 @@ release_pages (void)
       start = p->page;
       start_p = p;
       len = 0;
-      mapped_len = 0;
       newprev = prev;
       while (p && p->page == start + len)
         {
           len += p->bytes;
-	  if (!p->discarded)
-	      mapped_len += p->bytes;
 	  newprev = p;
           p = p->next;
         }
+      end_p = p;
+      run_prev = prev;
+#ifdef USING_HUGE_PAGES
+      if (flag_gc_huge_pages)
+	end_p = huge_page_subrun (&run_prev, &start_p, p, &start, &len);
+#endif
       if (len >= free_unit)
         {
-          while (start_p != p)
+	  mapped_len = 0;
+          while (start_p != end_p)
             {
               next = start_p->next;
+	      if (!start_p->discarded)
+		mapped_len += start_p->bytes;
               free (start_p);
               start_p = next;
             }
           munmap (start, len);
-	  if (prev)
-	    prev->next = p;
+	  if (run_prev)
+	    run_prev->next = end_p;
           else
-            G.free_pages = p;
+            G.free_pages = end_p;
           G.bytes_mapped -= mapped_len;
+	  /* Look at the pages left over after the released ones again.  */
+	  p = end_p;
+	  prev = run_prev;
 	  continue;
         }
       prev = newprev;
@@ -1088,6 +1194,18 @@ release_pages (void)
           len += p->bytes;
           p = p->next;
         }
+      end_p = p;
+#ifdef USING_HUGE_PAGES
+      if (flag_gc_huge_pages)
+	{
+	  size_t run_len = len;
+	  run_prev = NULL;
+	  end_p = huge_page_subrun (&run_prev, &start_p, p, &start, &len);
+	  G.huge_bytes_kept += run_len - len;
+	  if (len == 0)
+	    continue;
+	}
+#endif
       /* Give the page back to the kernel, but don't free the mapping.
          This avoids fragmentation in the virtual memory map of the 
  	 process. Next time we can reuse it by just touching it. */
@@ -1095,7 +1213,7 @@ release_pages (void)
       /* Don't count those pages as mapped to not touch the garbage collector
          unnecessarily. */
       G.bytes_mapped -= len;
-      while (start_p != p)
+      while (start_p != end_p)
         {
           start_p->discarded = true;
           start_p = start_p->next;
@@ -2308,6 +2426,14 @@ ggc_print_statistics (void)
 	   SCALE (G.bytes_mapped), STAT_LABEL (G.bytes_mapped),
 	   SCALE (G.allocated), STAT_LABEL (G.allocated),
 	   SCALE (total_overhead), STAT_LABEL (total_overhead));
+#ifdef USING_HUGE_PAGES
+  if (flag_gc_huge_pages)
+    fprintf (stderr, "Huge page regions: %lu, %lu%c mapped, "
+	     "%lu%c of free pages kept to avoid splitting huge pages\n",
+	     G.huge_regions,
+	     SCALE (G.huge_bytes_mapped), STAT_LABEL (G.huge_bytes_mapped),
+	     SCALE (G.huge_bytes_kept), STAT_LABEL (G.huge_bytes_kept));
+#endif
 
   if (GATHER_STATISTICS)
     {
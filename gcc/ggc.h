@@ -116,8 +116,9 @@ extern void init_ggc (void);
    hash.  */
 extern bool ggc_protect_identifiers;
 
-/* Write out all GCed objects to F.  */
-extern void gt_pch_save (FILE *f);
+/* Write out all GCed objects to F, and the address and size they must
+   be mapped at to *BASE and *SIZE.  */
+extern void gt_pch_save (FILE *f, void **base, size_t *size);
 
 
 /* Allocation.  */
@@ -33,10 +33,13 @@ along with GCC; see the file COPYING3.  If not see
 
 #define HOST_HOOKS_GT_PCH_ALLOC_GRANULARITY \
   default_gt_pch_alloc_granularity
+#define HOST_HOOKS_GT_PCH_ADDRESS_AVAILABLE_P \
+  default_gt_pch_address_available_p
 
 extern void* default_gt_pch_get_address (size_t, int);
 extern int default_gt_pch_use_address (void *, size_t, int, size_t);
 extern size_t default_gt_pch_alloc_granularity (void);
+extern bool default_gt_pch_address_available_p (void *, size_t);
 extern void* mmap_gt_pch_get_address (size_t, int);
 extern int mmap_gt_pch_use_address (void *, size_t, int, size_t);
 
@@ -45,7 +48,8 @@ extern int mmap_gt_pch_use_address (void *, size_t, int, size_t);
   HOST_HOOKS_EXTRA_SIGNALS,			\
   HOST_HOOKS_GT_PCH_GET_ADDRESS,		\
   HOST_HOOKS_GT_PCH_USE_ADDRESS,		\
-  HOST_HOOKS_GT_PCH_ALLOC_GRANULARITY		\
+  HOST_HOOKS_GT_PCH_ALLOC_GRANULARITY,		\
+  HOST_HOOKS_GT_PCH_ADDRESS_AVAILABLE_P		\
 }
 
 #endif /* GCC_HOST_HOOKS_DEF_H */
@@ -39,6 +39,11 @@ struct host_hooks
       this is the same as pagesize.  */
   size_t (*gt_pch_alloc_granularity) (void);
 
+  /* Return false if SIZE bytes at ADDR, the address a PCH file was written
+     for, are known to be unavailable, so that gt_pch_use_address would
+     fail.  Used to reject such a PCH file instead of failing to load it.  */
+  bool (*gt_pch_address_available_p) (void *addr, size_t size);
+
   /* Whenever you add entries here, make sure you adjust hosthooks-def.h.  */
 };
 
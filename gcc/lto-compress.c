@@ -32,6 +32,9 @@ along with GCC; see the file COPYING3.  If not see
    zlib.h needs to be included after, rather than before, config.h and
    system.h.  */
 #include <zlib.h>
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
 #include "lto-compress.h"
 #include "timevar.h"
 
@@ -48,11 +51,105 @@ struct lto_compression_stream
   bool is_compression;
 };
 
-/* Overall compression constants for zlib.  */
+/* A compression backend.  A compressed section is a sequence of segments,
+   each of which identifies its own format, so objects written with any
+   backend (including those from before backends were selectable) can be
+   read back.  */
 
-static const size_t Z_BUFFER_LENGTH = 4096;
+struct lto_compressor
+{
+  /* Return true if the SIZE bytes at DATA start a segment in this
+     backend's format.  */
+  bool (*match_p) (const unsigned char *data, size_t size);
+
+  /* Compress the SIZE bytes at DATA into one segment, passing the output
+     to STREAM's callback.  Return the number of compressed bytes.  */
+  size_t (*compress) (struct lto_compression_stream *stream,
+		      const unsigned char *data, size_t size);
+
+  /* Uncompress the segment at the start of the SIZE bytes at DATA, passing
+     the output to STREAM's callback.  Return the number of input bytes
+     the segment occupied.  */
+  size_t (*uncompress) (struct lto_compression_stream *stream,
+			const unsigned char *data, size_t size);
+};
+
+/* Overall compression constants.  */
+
+static const size_t LTO_BUFFER_LENGTH = 65536;
 static const size_t MIN_STREAM_ALLOCATION = 1024;
 
+/* The little-endian magic number that starts every zstd frame.  No valid
+   zlib header matches it.  */
+
+static const unsigned LTO_ZSTD_MAGIC = 0xFD2FB528;
+
+/* Return true if the SIZE bytes at DATA start a zstd frame.  */
+
+static bool
+lto_zstd_frame_p (const unsigned char *data, size_t size)
+{
+  return (size >= 4
+	  && (data[0] | (data[1] << 8) | (data[2] << 16)
+	      | ((unsigned) data[3] << 24)) == LTO_ZSTD_MAGIC);
+}
+
+/* Pass the LENGTH bytes at DATA to STREAM's callback, in chunks the
+   callback's unsigned length can represent.  */
+
+static void
+lto_flush_compression_output (struct lto_compression_stream *stream,
+			      const unsigned char *data, size_t length)
+{
+  while (length > 0)
+    {
+      unsigned chunk = MIN (length, (size_t) UINT_MAX);
+      stream->callback ((const char *) data, chunk, stream->opaque);
+      data += chunk;
+      length -= chunk;
+    }
+}
+
+/* Return true if the SIZE bytes at DATA are a section stored without
+   compression.  Every section starts with an lto_header, and its major
+   version can never be confused with the first bytes of a zlib or zstd
+   segment.  */
+
+static bool
+lto_raw_match_p (const unsigned char *data, size_t size)
+{
+  lto_header header;
+
+  if (size < sizeof (header))
+    return false;
+  memcpy (&header, data, sizeof (header));
+  return header.major_version == LTO_major_version;
+}
+
+/* Store SIZE bytes at DATA without compression.  */
+
+static size_t
+lto_raw_compress (struct lto_compression_stream *stream,
+		  const unsigned char *data, size_t size)
+{
+  lto_flush_compression_output (stream, data, size);
+  return size;
+}
+
+/* Pass on the SIZE bytes at DATA, which form the whole section.  */
+
+static size_t
+lto_raw_uncompress (struct lto_compression_stream *stream,
+		    const unsigned char *data, size_t size)
+{
+  lto_flush_compression_output (stream, data, size);
+  return size;
+}
+
+static const struct lto_compressor lto_raw_compressor = {
+  lto_raw_match_p, lto_raw_compress, lto_raw_uncompress
+};
+
 /* For zlib, allocate SIZE count of ITEMS and return the address, OPAQUE
    is unused.  */
 
@@ -92,6 +189,258 @@ lto_normalized_zlib_level (void)
   return level;
 }
 
+/* Return true if DATA starts a zlib stream.  This is the fallback format,
+   so accept anything.  */
+
+static bool
+lto_zlib_match_p (const unsigned char *, size_t)
+{
+  return true;
+}
+
+/* Compress SIZE bytes at DATA with zlib.  */
+
+static size_t
+lto_zlib_compress (struct lto_compression_stream *stream,
+		   const unsigned char *data, size_t size)
+{
+  unsigned char *cursor = CONST_CAST (unsigned char *, data);
+  size_t remaining = size;
+  const size_t outbuf_length = LTO_BUFFER_LENGTH;
+  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
+  z_stream out_stream;
+  size_t compressed_bytes = 0;
+  int status;
+
+  out_stream.next_out = outbuf;
+  out_stream.avail_out = outbuf_length;
+  out_stream.next_in = cursor;
+  out_stream.avail_in = remaining;
+  out_stream.zalloc = lto_zalloc;
+  out_stream.zfree = lto_zfree;
+  out_stream.opaque = Z_NULL;
+
+  status = deflateInit (&out_stream, lto_normalized_zlib_level ());
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  do
+    {
+      size_t in_bytes, out_bytes;
+
+      status = deflate (&out_stream, Z_FINISH);
+      if (status != Z_OK && status != Z_STREAM_END)
+	internal_error ("compressed stream: %s", zError (status));
+
+      in_bytes = remaining - out_stream.avail_in;
+      out_bytes = outbuf_length - out_stream.avail_out;
+
+      lto_flush_compression_output (stream, outbuf, out_bytes);
+      compressed_bytes += out_bytes;
+
+      cursor += in_bytes;
+      remaining -= in_bytes;
+
+      out_stream.next_out = outbuf;
+      out_stream.avail_out = outbuf_length;
+      out_stream.next_in = cursor;
+      out_stream.avail_in = remaining;
+    }
+  while (status != Z_STREAM_END);
+
+  status = deflateEnd (&out_stream);
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  free (outbuf);
+  return compressed_bytes;
+}
+
+/* Uncompress the zlib stream at the start of the SIZE bytes at DATA.  */
+
+static size_t
+lto_zlib_uncompress (struct lto_compression_stream *stream,
+		     const unsigned char *data, size_t size)
+{
+  unsigned char *cursor = CONST_CAST (unsigned char *, data);
+  size_t remaining = size;
+  const size_t outbuf_length = LTO_BUFFER_LENGTH;
+  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
+  z_stream in_stream;
+  size_t out_bytes;
+  int status;
+
+  in_stream.next_out = outbuf;
+  in_stream.avail_out = outbuf_length;
+  in_stream.next_in = cursor;
+  in_stream.avail_in = remaining;
+  in_stream.zalloc = lto_zalloc;
+  in_stream.zfree = lto_zfree;
+  in_stream.opaque = Z_NULL;
+
+  status = inflateInit (&in_stream);
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  do
+    {
+      size_t in_bytes;
+
+      status = inflate (&in_stream, Z_SYNC_FLUSH);
+      if (status != Z_OK && status != Z_STREAM_END)
+	internal_error ("compressed stream: %s", zError (status));
+
+      in_bytes = remaining - in_stream.avail_in;
+      out_bytes = outbuf_length - in_stream.avail_out;
+
+      lto_flush_compression_output (stream, outbuf, out_bytes);
+      lto_stats.num_uncompressed_il_bytes += out_bytes;
+
+      cursor += in_bytes;
+      remaining -= in_bytes;
+
+      in_stream.next_out = outbuf;
+      in_stream.avail_out = outbuf_length;
+      in_stream.next_in = cursor;
+      in_stream.avail_in = remaining;
+    }
+  while (!(status == Z_STREAM_END && out_bytes == 0));
+
+  status = inflateEnd (&in_stream);
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  free (outbuf);
+  return size - remaining;
+}
+
+static const struct lto_compressor lto_zlib_compressor = {
+  lto_zlib_match_p, lto_zlib_compress, lto_zlib_uncompress
+};
+
+#ifdef HAVE_ZSTD_H
+/* Return a zstd compression level from the command line flag, using
+   zstd's default for the default setting and clamping other values to
+   the range zstd accepts.  */
+
+static int
+lto_normalized_zstd_level (void)
+{
+  int level = flag_lto_compression_level;
+
+  if (level < 0)
+    level = 3;
+  else if (level < 1)
+    level = 1;
+  else if (level > ZSTD_maxCLevel ())
+    level = ZSTD_maxCLevel ();
+
+  return level;
+}
+
+/* Compress SIZE bytes at DATA into a single zstd frame.  */
+
+static size_t
+lto_zstd_compress (struct lto_compression_stream *stream,
+		   const unsigned char *data, size_t size)
+{
+  size_t outbuf_length = ZSTD_compressBound (size);
+  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
+
+  size_t out_bytes = ZSTD_compress (outbuf, outbuf_length, data, size,
+				    lto_normalized_zstd_level ());
+  if (ZSTD_isError (out_bytes))
+    internal_error ("compressed stream: %s", ZSTD_getErrorName (out_bytes));
+
+  lto_flush_compression_output (stream, outbuf, out_bytes);
+
+  free (outbuf);
+  return out_bytes;
+}
+
+/* Uncompress the zstd frame at the start of the SIZE bytes at DATA.  */
+
+static size_t
+lto_zstd_uncompress (struct lto_compression_stream *stream,
+		     const unsigned char *data, size_t size)
+{
+  const size_t outbuf_length = LTO_BUFFER_LENGTH;
+  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
+  ZSTD_DStream *dstream = ZSTD_createDStream ();
+  ZSTD_inBuffer in = { data, size, 0 };
+  size_t status;
+
+  if (dstream == NULL)
+    internal_error ("compressed stream: cannot allocate zstd context");
+  status = ZSTD_initDStream (dstream);
+  if (ZSTD_isError (status))
+    internal_error ("compressed stream: %s", ZSTD_getErrorName (status));
+
+  /* ZSTD_decompressStream returns 0 once the frame is complete.  */
+  do
+    {
+      ZSTD_outBuffer out = { outbuf, outbuf_length, 0 };
+
+      status = ZSTD_decompressStream (dstream, &out, &in);
+      if (ZSTD_isError (status))
+	internal_error ("compressed stream: %s", ZSTD_getErrorName (status));
+      if (status != 0 && out.pos == 0 && in.pos == size)
+	internal_error ("compressed stream: truncated zstd frame");
+
+      lto_flush_compression_output (stream, outbuf, out.pos);
+      lto_stats.num_uncompressed_il_bytes += out.pos;
+    }
+  while (status != 0);
+
+  ZSTD_freeDStream (dstream);
+  free (outbuf);
+  return in.pos;
+}
+
+static const struct lto_compressor lto_zstd_compressor = {
+  lto_zstd_frame_p, lto_zstd_compress, lto_zstd_uncompress
+};
+#endif
+
+/* The backends that can read a segment, in order of preference when
+   matching.  The last one must accept anything.  */
+
+static const struct lto_compressor *const lto_compressors[] = {
+  &lto_raw_compressor,
+#ifdef HAVE_ZSTD_H
+  &lto_zstd_compressor,
+#endif
+  &lto_zlib_compressor
+};
+
+/* Return the backend to compress with, as selected by
+   -flto-compression-algorithm.  Level 0 stores sections as they are, so
+   that readers can use them in place.  */
+
+static const struct lto_compressor *
+lto_selected_compressor (void)
+{
+  if (flag_lto_compression_level == 0)
+    return &lto_raw_compressor;
+
+  switch (flag_lto_compression_algorithm)
+    {
+    case LTO_COMPRESSION_ZLIB:
+      return &lto_zlib_compressor;
+
+    case LTO_COMPRESSION_ZSTD:
+    case LTO_COMPRESSION_DEFAULT:
+#ifdef HAVE_ZSTD_H
+      return &lto_zstd_compressor;
+#else
+      return &lto_zlib_compressor;
+#endif
+
+    default:
+      gcc_unreachable ();
+    }
+}
+
 /* Create a new compression stream, with CALLBACK flush function passed
    OPAQUE token, IS_COMPRESSION indicates if compressing or uncompressing.  */
 
@@ -168,61 +517,16 @@ lto_compress_block (struct lto_compression_stream *stream,
 void
 lto_end_compression (struct lto_compression_stream *stream)
 {
-  unsigned char *cursor = (unsigned char *) stream->buffer;
-  size_t remaining = stream->bytes;
-  const size_t outbuf_length = Z_BUFFER_LENGTH;
-  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
-  z_stream out_stream;
-  size_t compressed_bytes = 0;
-  int status;
-
   gcc_assert (stream->is_compression);
 
   timevar_push (TV_IPA_LTO_COMPRESS);
 
-  out_stream.next_out = outbuf;
-  out_stream.avail_out = outbuf_length;
-  out_stream.next_in = cursor;
-  out_stream.avail_in = remaining;
-  out_stream.zalloc = lto_zalloc;
-  out_stream.zfree = lto_zfree;
-  out_stream.opaque = Z_NULL;
-
-  status = deflateInit (&out_stream, lto_normalized_zlib_level ());
-  if (status != Z_OK)
-    internal_error ("compressed stream: %s", zError (status));
-
-  do
-    {
-      size_t in_bytes, out_bytes;
-
-      status = deflate (&out_stream, Z_FINISH);
-      if (status != Z_OK && status != Z_STREAM_END)
-	internal_error ("compressed stream: %s", zError (status));
-
-      in_bytes = remaining - out_stream.avail_in;
-      out_bytes = outbuf_length - out_stream.avail_out;
-
-      stream->callback ((const char *) outbuf, out_bytes, stream->opaque);
-      lto_stats.num_compressed_il_bytes += out_bytes;
-      compressed_bytes += out_bytes;
-
-      cursor += in_bytes;
-      remaining -= in_bytes;
-
-      out_stream.next_out = outbuf;
-      out_stream.avail_out = outbuf_length;
-      out_stream.next_in = cursor;
-      out_stream.avail_in = remaining;
-    }
-  while (status != Z_STREAM_END);
-
-  status = deflateEnd (&out_stream);
-  if (status != Z_OK)
-    internal_error ("compressed stream: %s", zError (status));
+  const struct lto_compressor *compressor = lto_selected_compressor ();
+  lto_stats.num_compressed_il_bytes
+    += compressor->compress (stream, (const unsigned char *) stream->buffer,
+			     stream->bytes);
 
   lto_destroy_compression_stream (stream);
-  free (outbuf);
   timevar_pop (TV_IPA_LTO_COMPRESS);
 }
 
@@ -248,73 +552,81 @@ lto_uncompress_block (struct lto_compression_stream *stream,
   lto_stats.num_input_il_bytes += num_chars;
 }
 
-/* Finalize STREAM uncompression, and free stream allocations.
+/* Uncompress the SIZE bytes at DATA into STREAM.
 
    Because of the way LTO IL streams are compressed, there may be several
-   concatenated compressed segments in the accumulated data, so for this
-   function we iterate decompressions until no data remains.  */
+   concatenated compressed segments in the data, so for this function we
+   iterate decompressions until no data remains.  Each segment is handed
+   to the first backend that recognizes its format.  */
 
-void
-lto_end_uncompression (struct lto_compression_stream *stream)
+static void
+lto_uncompress_segments (struct lto_compression_stream *stream,
+			 const unsigned char *data, size_t size)
 {
-  unsigned char *cursor = (unsigned char *) stream->buffer;
-  size_t remaining = stream->bytes;
-  const size_t outbuf_length = Z_BUFFER_LENGTH;
-  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
-  size_t uncompressed_bytes = 0;
+  const unsigned char *cursor = data;
+  size_t remaining = size;
 
-  gcc_assert (!stream->is_compression);
   timevar_push (TV_IPA_LTO_DECOMPRESS);
 
   while (remaining > 0)
     {
-      z_stream in_stream;
-      size_t out_bytes;
-      int status;
-
-      in_stream.next_out = outbuf;
-      in_stream.avail_out = outbuf_length;
-      in_stream.next_in = cursor;
-      in_stream.avail_in = remaining;
-      in_stream.zalloc = lto_zalloc;
-      in_stream.zfree = lto_zfree;
-      in_stream.opaque = Z_NULL;
+#ifndef HAVE_ZSTD_H
+      if (lto_zstd_frame_p (cursor, remaining))
+	fatal_error (input_location,
+		     "LTO section is compressed with zstd, which this "
+		     "compiler was built without");
+#endif
+
+      const struct lto_compressor *compressor = NULL;
+      for (unsigned i = 0; i < ARRAY_SIZE (lto_compressors); i++)
+	if (lto_compressors[i]->match_p (cursor, remaining))
+	  {
+	    compressor = lto_compressors[i];
+	    break;
+	  }
+      gcc_assert (compressor);
+
+      size_t in_bytes = compressor->uncompress (stream, cursor, remaining);
+      cursor += in_bytes;
+      remaining -= in_bytes;
+    }
 
-      status = inflateInit (&in_stream);
-      if (status != Z_OK)
-	internal_error ("compressed stream: %s", zError (status));
+  timevar_pop (TV_IPA_LTO_DECOMPRESS);
+}
 
-      do
-	{
-	  size_t in_bytes;
+/* Finalize STREAM uncompression, and free stream allocations.  */
 
-	  status = inflate (&in_stream, Z_SYNC_FLUSH);
-	  if (status != Z_OK && status != Z_STREAM_END)
-	    internal_error ("compressed stream: %s", zError (status));
+void
+lto_end_uncompression (struct lto_compression_stream *stream)
+{
+  gcc_assert (!stream->is_compression);
 
-	  in_bytes = remaining - in_stream.avail_in;
-	  out_bytes = outbuf_length - in_stream.avail_out;
+  lto_uncompress_segments (stream, (const unsigned char *) stream->buffer,
+			   stream->bytes);
+  lto_destroy_compression_stream (stream);
+}
 
-	  stream->callback ((const char *) outbuf, out_bytes, stream->opaque);
-	  lto_stats.num_uncompressed_il_bytes += out_bytes;
-	  uncompressed_bytes += out_bytes;
+/* Uncompress the NUM_CHARS at address BASE, passing the output to
+   CALLBACK with OPAQUE token.  Unlike lto_uncompress_block this reads
+   BASE directly rather than buffering a copy of it first.  */
 
-	  cursor += in_bytes;
-	  remaining -= in_bytes;
+void
+lto_uncompress_data (void (*callback) (const char *, unsigned, void *),
+		     void *opaque, const char *base, size_t num_chars)
+{
+  struct lto_compression_stream *stream
+    = lto_new_compression_stream (callback, opaque, false);
 
-	  in_stream.next_out = outbuf;
-	  in_stream.avail_out = outbuf_length;
-	  in_stream.next_in = cursor;
-	  in_stream.avail_in = remaining;
-	}
-      while (!(status == Z_STREAM_END && out_bytes == 0));
+  lto_stats.num_input_il_bytes += num_chars;
+  lto_uncompress_segments (stream, (const unsigned char *) base, num_chars);
+  lto_destroy_compression_stream (stream);
+}
 
-      status = inflateEnd (&in_stream);
-      if (status != Z_OK)
-	internal_error ("compressed stream: %s", zError (status));
-    }
+/* Return true if the NUM_CHARS at address BASE form a section that was
+   stored without compression and can be used as it is.  */
 
-  lto_destroy_compression_stream (stream);
-  free (outbuf);
-  timevar_pop (TV_IPA_LTO_DECOMPRESS);
+bool
+lto_uncompressed_section_p (const char *base, size_t num_chars)
+{
+  return lto_raw_match_p ((const unsigned char *) base, num_chars);
 }
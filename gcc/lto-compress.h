@@ -38,5 +38,10 @@ extern struct lto_compression_stream
 extern void lto_uncompress_block (struct lto_compression_stream *stream,
 				  const char *base, size_t num_chars);
 extern void lto_end_uncompression (struct lto_compression_stream *stream);
+extern void lto_uncompress_data (void (*callback) (const char *, unsigned,
+						   void *),
+				 void *opaque, const char *base,
+				 size_t num_chars);
+extern bool lto_uncompressed_section_p (const char *base, size_t num_chars);
 
 #endif /* GCC_LTO_COMPRESS_H  */
@@ -178,6 +178,12 @@ lto_write_options (void)
 	case OPT_SPECIAL_input_file:
 	  continue;
 
+	/* The WPA stage names temporary files here, which would make the
+	   LTRANS units differ from link to link.  */
+	case OPT_fltrans_output_list_:
+	case OPT_fresolution_:
+	  continue;
+
 	default:
 	  break;
       }
@@ -95,17 +95,24 @@ struct lto_buffer
 {
   char *data;
   size_t length;
+  size_t allocation;
 };
 
 /* Compression callback, append LENGTH bytes from DATA to the buffer pointed
-   to by OPAQUE.  */
+   to by OPAQUE.  The buffer grows geometrically, so that uncompressing a
+   large section does not reallocate it for every chunk.  */
 
 static void
 lto_append_data (const char *data, unsigned length, void *opaque)
 {
   struct lto_buffer *buffer = (struct lto_buffer *) opaque;
 
-  buffer->data = (char *) xrealloc (buffer->data, buffer->length + length);
+  if (buffer->allocation < buffer->length + length)
+    {
+      buffer->allocation = MAX (2 * buffer->allocation,
+				buffer->length + length);
+      buffer->data = (char *) xrealloc (buffer->data, buffer->allocation);
+    }
   memcpy (buffer->data + buffer->length, data, length);
   buffer->length += length;
 }
@@ -120,6 +127,11 @@ struct lto_data_header
   size_t len;
 };
 
+/* Sections stored without compression that lto_get_section_data handed
+   out in place, without a header.  */
+
+static hash_set<const char *> *lto_in_place_sections;
+
 /* Return a char pointer to the start of a data stream for an LTO pass
    or function.  FILE_DATA indicates where to obtain the data.
    SECTION_TYPE is the type of information to be obtained.  NAME is
@@ -137,7 +149,6 @@ lto_get_section_data (struct lto_file_decl_data *file_data,
   const size_t header_length = sizeof (struct lto_data_header);
   struct lto_data_header *header;
   struct lto_buffer buffer;
-  struct lto_compression_stream *stream;
   lto_stats.section_size[section_type] += *len;
 
   if (data == NULL)
@@ -146,7 +157,17 @@ lto_get_section_data (struct lto_file_decl_data *file_data,
   /* WPA->ltrans streams are not compressed with exception of function bodies
      and variable initializers that has been verbatim copied from earlier
      compilations.  */
-  if (!flag_ltrans || decompress)
+  if ((!flag_ltrans || decompress)
+      && lto_uncompressed_section_p (data, *len))
+    {
+      /* Use sections stored without compression directly from the
+	 underlying data rather than copying them.  */
+      if (!lto_in_place_sections)
+	lto_in_place_sections = new hash_set<const char *>;
+      lto_in_place_sections->add (data);
+      lto_stats.num_input_il_bytes += *len;
+    }
+  else if (!flag_ltrans || decompress)
     {
       /* Create a mapping header containing the underlying data and length,
 	 and prepend this to the uncompression buffer.  The uncompressed data
@@ -158,10 +179,9 @@ lto_get_section_data (struct lto_file_decl_data *file_data,
 
       buffer.data = (char *) header;
       buffer.length = header_length;
+      buffer.allocation = header_length;
 
-      stream = lto_start_uncompression (lto_append_data, &buffer);
-      lto_uncompress_block (stream, data, *len);
-      lto_end_uncompression (stream);
+      lto_uncompress_data (lto_append_data, &buffer, data, *len);
 
       *len = buffer.length - header_length;
       data = buffer.data + header_length;
@@ -208,6 +228,13 @@ lto_free_section_data (struct lto_file_decl_data *file_data,
       return;
     }
 
+  if (lto_in_place_sections && lto_in_place_sections->contains (data))
+    {
+      lto_in_place_sections->remove (data);
+      (free_section_f) (file_data, section_type, name, data, len);
+      return;
+    }
+
   /* The underlying data address has been extracted from the mapping header.
      Free that, then free the allocated uncompression buffer.  */
   (free_section_f) (file_data, section_type, name, header->data, header->len);
@@ -48,6 +48,8 @@ along with GCC; see the file COPYING3.  If not see
 #include "simple-object.h"
 #include "lto-section-names.h"
 #include "collect-utils.h"
+#include "md5.h"
+#include "version.h"
 
 /* Environment variable, used for passing the names of offload targets from GCC
    driver to lto-wrapper.  */
@@ -940,6 +942,310 @@ find_and_merge_options (int fd, off_t file_offset, const char *prefix,
   return true;
 }
 
+/* Copy the contents of file SRC to file DST.  Return true on success.  */
+
+static bool
+copy_file (const char *src, const char *dst)
+{
+  char buf[65536];
+  size_t len;
+  bool ok = true;
+  FILE *in, *out;
+
+  in = fopen (src, "rb");
+  if (!in)
+    return false;
+  out = fopen (dst, "wb");
+  if (!out)
+    {
+      fclose (in);
+      return false;
+    }
+  while ((len = fread (buf, 1, sizeof (buf), in)) > 0)
+    if (fwrite (buf, 1, len, out) != len)
+      {
+	ok = false;
+	break;
+      }
+  if (ferror (in))
+    ok = false;
+  fclose (in);
+  if (fclose (out) != 0)
+    ok = false;
+  return ok;
+}
+
+/* Compute the -flto-incremental cache key of the LTRANS unit INPUT_NAME
+   compiled with the common arguments ARGV[0] ... ARGV[ARGC - 1] and return
+   the name of the corresponding object file in cache directory DIR, or
+   NULL if INPUT_NAME cannot be read.  The WPA stage streams everything an
+   LTRANS unit depends on (symbols, bodies and the merged options) into
+   its input file, so its contents together with the command line and
+   the compiler version identify the output.  */
+
+static char *
+ltrans_cache_entry (const char *dir, const char **argv, unsigned argc,
+		    const char *input_name)
+{
+  static const char hex[] = "0123456789abcdef";
+  unsigned char digest[16];
+  struct md5_ctx ctx;
+  char *entry, *p;
+  unsigned i;
+  FILE *f;
+
+  f = fopen (input_name, "rb");
+  if (!f)
+    return NULL;
+  if (md5_stream (f, digest) != 0)
+    {
+      fclose (f);
+      return NULL;
+    }
+  fclose (f);
+
+  md5_init_ctx (&ctx);
+  md5_process_bytes (digest, sizeof (digest), &ctx);
+  md5_process_bytes (version_string, strlen (version_string) + 1, &ctx);
+  for (i = 0; i < argc; ++i)
+    md5_process_bytes (argv[i], strlen (argv[i]) + 1, &ctx);
+  md5_finish_ctx (&ctx, digest);
+
+  entry = XNEWVEC (char, strlen (dir) + 1 + 2 * sizeof (digest)
+			 + sizeof (".ltrans.o"));
+  strcpy (entry, dir);
+  p = entry + strlen (entry);
+  if (p != entry && !IS_DIR_SEPARATOR (p[-1]))
+    *p++ = DIR_SEPARATOR;
+  for (i = 0; i < sizeof (digest); ++i)
+    {
+      *p++ = hex[digest[i] >> 4];
+      *p++ = hex[digest[i] & 0xf];
+    }
+  strcpy (p, ".ltrans.o");
+  return entry;
+}
+
+/* Store the LTRANS object OUTPUT_NAME as cache entry ENTRY.  The object
+   is copied to a temporary file first and then renamed so that concurrent
+   links sharing the cache never see a partially written entry.  Failures
+   only cost a future cache miss, so they are reported with -v only.  */
+
+static void
+ltrans_cache_store (const char *entry, const char *output_name)
+{
+  char *tmp = concat (entry, ".tmp", NULL);
+  char pid[32];
+
+  sprintf (pid, "%ld", (long) getpid ());
+  tmp = reconcat (tmp, tmp, pid, NULL);
+  if (!copy_file (output_name, tmp) || rename (tmp, entry) != 0)
+    {
+      if (verbose)
+	fprintf (stderr, "[Cannot cache LTRANS %s as %s]\n",
+		 output_name, entry);
+      unlink (tmp);
+    }
+  free (tmp);
+}
+
+/* An LTRANS compilation run by run_ltrans_jobs.  */
+
+struct ltrans_job
+{
+  /* Command line of the compilation.  */
+  char **argv;
+  /* LTRANS input file, removed once the compilation finished.  */
+  const char *input_name;
+  /* Size of the input file, used as an estimate of the compile time.  */
+  off_t size;
+  /* Position in the LTRANS output list.  */
+  unsigned index;
+};
+
+/* Sort LTRANS jobs by decreasing size, keeping the order of the output
+   list for jobs of equal size.  */
+
+static int
+ltrans_job_cmp (const void *p1, const void *p2)
+{
+  const struct ltrans_job *j1 = (const struct ltrans_job *) p1;
+  const struct ltrans_job *j2 = (const struct ltrans_job *) p2;
+
+  if (j1->size != j2->size)
+    return j1->size < j2->size ? 1 : -1;
+  return j1->index < j2->index ? -1 : j1->index > j2->index;
+}
+
+#ifdef HAVE_WORKING_FORK
+
+/* Start JOB in a child process and return its pid.  */
+
+static pid_t
+start_ltrans_job (struct ltrans_job *job)
+{
+  pid_t pid;
+
+  if (verbose || debug)
+    {
+      char **p;
+
+      fprintf (stderr, "%s", job->argv[0]);
+      for (p = &job->argv[1]; *p; p++)
+	fprintf (stderr, " %s", *p);
+      fprintf (stderr, "\n");
+    }
+
+  fflush (stdout);
+  fflush (stderr);
+
+  pid = fork ();
+  if (pid < 0)
+    fatal_error (input_location, "fork failed: %m");
+  if (pid == 0)
+    {
+      execvp (job->argv[0], job->argv);
+      fprintf (stderr, "%s: %s\n", job->argv[0], xstrerror (errno));
+      _exit (127);
+    }
+  return pid;
+}
+
+/* Terminate and reap the PARALLEL jobs still recorded in RUNNING, so that
+   none of them outlives a failed link.  Free slots hold zero.  */
+
+static void
+kill_ltrans_jobs (pid_t *running, unsigned parallel)
+{
+  unsigned slot;
+
+  for (slot = 0; slot < parallel; slot++)
+    if (running[slot] > 0)
+      kill (running[slot], SIGTERM);
+
+  for (slot = 0; slot < parallel; slot++)
+    if (running[slot] > 0)
+      {
+	int status;
+
+	while (waitpid (running[slot], &status, 0) < 0 && errno == EINTR)
+	  ;
+	running[slot] = 0;
+      }
+}
+
+/* Run the NJOBS LTRANS compilations in JOBS with at most PARALLEL of them
+   at a time, without the help of make.  The largest units are started
+   first so that the compilations still running at the end are the short
+   ones.  Whenever a compilation finishes, whichever it is, the next job
+   is started in its place, so one long unit does not hold back the
+   slots freed by the shorter ones.  */
+
+static void
+run_ltrans_jobs (struct ltrans_job *jobs, unsigned njobs, unsigned parallel)
+{
+  pid_t *running = XCNEWVEC (pid_t, parallel);
+  unsigned *running_job = XNEWVEC (unsigned, parallel);
+  unsigned count, i;
+
+  qsort (jobs, njobs, sizeof (struct ltrans_job), ltrans_job_cmp);
+
+  for (i = 0; i < njobs && i < parallel; i++)
+    {
+      running[i] = start_ltrans_job (&jobs[i]);
+      running_job[i] = i;
+    }
+
+  for (count = i; count; )
+    {
+      unsigned slot;
+      int status;
+      pid_t pid;
+
+      do
+	pid = waitpid (-1, &status, 0);
+      while (pid < 0 && errno == EINTR);
+      if (pid < 0)
+	fatal_error (input_location, "can't get program status: %m");
+
+      for (slot = 0; slot < parallel; slot++)
+	if (running[slot] == pid)
+	  break;
+      if (slot == parallel)
+	continue;
+
+      struct ltrans_job *job = &jobs[running_job[slot]];
+      running[slot] = 0;
+      if (WIFSIGNALED (status)
+	  || (WIFEXITED (status) && WEXITSTATUS (status) != 0))
+	kill_ltrans_jobs (running, parallel);
+      if (WIFSIGNALED (status))
+	{
+	  int sig = WTERMSIG (status);
+	  fatal_error (input_location, "%s terminated with signal %d [%s]%s",
+		       job->argv[0], sig, strsignal (sig),
+		       WCOREDUMP (status) ? ", core dumped" : "");
+	}
+      if (WIFEXITED (status) && WEXITSTATUS (status) != 0)
+	fatal_error (input_location, "%s returned %d exit status",
+		     job->argv[0], WEXITSTATUS (status));
+      maybe_unlink (job->input_name);
+      XDELETEVEC (job->argv);
+
+      if (i < njobs)
+	{
+	  running[slot] = start_ltrans_job (&jobs[i]);
+	  running_job[slot] = i++;
+	}
+      else
+	count--;
+    }
+
+  XDELETEVEC (running_job);
+  XDELETEVEC (running);
+}
+
+#else
+
+/* Without fork the pex interface can only wait for a given child, so
+   jobs are reaped in the order they were started, which with the
+   ordering above approximates the order in which they finish.  */
+
+static void
+run_ltrans_jobs (struct ltrans_job *jobs, unsigned njobs, unsigned parallel)
+{
+  struct pex_obj **running = XNEWVEC (struct pex_obj *, parallel);
+  unsigned *running_job = XNEWVEC (unsigned, parallel);
+  unsigned head = 0, count = 0, i;
+
+  qsort (jobs, njobs, sizeof (struct ltrans_job), ltrans_job_cmp);
+
+  for (i = 0; i < njobs || count; )
+    {
+      if (i < njobs && count < parallel)
+	{
+	  unsigned slot = (head + count++) % parallel;
+	  running[slot] = collect_execute (jobs[i].argv[0], jobs[i].argv,
+					   NULL, NULL,
+					   PEX_LAST | PEX_SEARCH, false);
+	  running_job[slot] = i++;
+	  continue;
+	}
+
+      struct ltrans_job *job = &jobs[running_job[head]];
+      do_wait (job->argv[0], running[head]);
+      maybe_unlink (job->input_name);
+      XDELETEVEC (job->argv);
+      head = (head + 1) % parallel;
+      count--;
+    }
+
+  XDELETEVEC (running_job);
+  XDELETEVEC (running);
+}
+
+#endif
+
 /* Execute gcc. ARGC is the number of arguments. ARGV contains the arguments. */
 
 static void
@@ -954,6 +1260,8 @@ run_gcc (unsigned argc, char *argv[])
   int parallel = 0;
   int jobserver = 0;
   bool no_partition = false;
+  bool partition_given = false;
+  const char *incremental_dir = NULL;
   struct cl_decoded_option *fdecoded_options = NULL;
   struct cl_decoded_option *offload_fdecoded_options = NULL;
   unsigned int fdecoded_options_count = 0;
@@ -1060,10 +1368,15 @@ run_gcc (unsigned argc, char *argv[])
 	  break;
 
 	case OPT_flto_partition_:
+	  partition_given = true;
 	  if (strcmp (option->arg, "none") == 0)
 	    no_partition = true;
 	  break;
 
+	case OPT_flto_incremental_:
+	  incremental_dir = option->arg;
+	  break;
+
 	case OPT_flto_:
 	  if (strcmp (option->arg, "jobserver") == 0)
 	    {
@@ -1264,6 +1577,21 @@ cont1:
       tmp += list_option_len;
       strcpy (tmp, ltrans_output_file);
 
+      /* For -flto-incremental, unchanged LTRANS units must come out of
+	 WPA byte for byte the same.  Fix the seed that WPA otherwise
+	 draws at random for the section name suffixes, and unless asked
+	 otherwise partition along the input files, whose boundaries do
+	 not move when a single unit is edited.  */
+      if (incremental_dir)
+	{
+	  obstack_ptr_grow (&argv_obstack,
+			    concat ("-frandom-seed=",
+				    linker_output ? linker_output : "a.out",
+				    NULL));
+	  if (!partition_given)
+	    obstack_ptr_grow (&argv_obstack, "-flto-partition=1to1");
+	}
+
       if (jobserver)
 	obstack_ptr_grow (&argv_obstack, xstrdup ("-fwpa=jobserver"));
       else if (parallel > 1)
@@ -1295,6 +1623,9 @@ cont1:
     {
       FILE *stream = fopen (ltrans_output_file, "r");
       FILE *mstream = NULL;
+      char **cache_entries = NULL;
+      struct ltrans_job *jobs = NULL;
+      unsigned njobs = 0;
       struct obstack env_obstack;
 
       if (!stream)
@@ -1336,14 +1667,27 @@ cont:
       maybe_unlink (ltrans_output_file);
       ltrans_output_file = NULL;
 
-      if (parallel)
+      /* With a jobserver, let make schedule the LTRANS compilations so
+	 that they share its job slots.  Otherwise run them ourselves.  */
+      if (jobserver)
 	{
 	  makefile = make_temp_file (".mk");
 	  mstream = fopen (makefile, "w");
 	}
+      else if (parallel)
+	jobs = XNEWVEC (struct ltrans_job, nr);
+
+      if (incremental_dir)
+	{
+	  if (mkdir (incremental_dir, S_IRWXU | S_IRWXG | S_IRWXO) == -1
+	      && errno != EEXIST)
+	    fatal_error (input_location, "cannot create directory %s: %m",
+			 incremental_dir);
+	  cache_entries = XCNEWVEC (char *, nr);
+	}
 
-      /* Execute the LTRANS stage for each input file (or prepare a
-	 makefile to invoke this in parallel).  */
+      /* Execute the LTRANS stage for each input file (or queue it to be
+	 executed in parallel).  */
       for (i = 0; i < nr; ++i)
 	{
 	  char *output_name;
@@ -1375,7 +1719,30 @@ cont:
 	  argv_ptr[3] = output_name;
 	  argv_ptr[4] = input_name;
 	  argv_ptr[5] = NULL;
-	  if (parallel)
+
+	  /* Reuse the object of an identical LTRANS unit compiled by an
+	     earlier link if there is one.  The dumpbase only affects the
+	     names of auxiliary files and is not part of the key.  */
+	  if (incremental_dir)
+	    {
+	      char *entry = ltrans_cache_entry (incremental_dir, new_argv,
+						new_head_argc, input_name);
+	      if (entry
+		  && access (entry, R_OK) == 0
+		  && copy_file (entry, output_name))
+		{
+		  if (verbose)
+		    fprintf (stderr, "[Reusing LTRANS %s for %s]\n",
+			     entry, input_name);
+		  free (entry);
+		  maybe_unlink (input_name);
+		  output_names[i] = output_name;
+		  continue;
+		}
+	      cache_entries[i] = entry;
+	    }
+
+	  if (jobserver)
 	    {
 	      fprintf (mstream, "%s:\n\t@%s ", output_name, new_argv[0]);
 	      for (j = 1; new_argv[j] != NULL; ++j)
@@ -1389,6 +1756,19 @@ cont:
 			 "&& mv %s.tem %s\n",
 			 input_name, input_name, input_name, input_name); 
 	    }
+	  else if (parallel)
+	    {
+	      struct ltrans_job *job = &jobs[njobs++];
+	      struct stat st;
+
+	      for (j = 0; new_argv[j] != NULL; ++j)
+		;
+	      job->argv = XNEWVEC (char *, j + 1);
+	      memcpy (job->argv, new_argv, (j + 1) * sizeof (char *));
+	      job->input_name = input_name;
+	      job->size = stat (input_name, &st) == 0 ? st.st_size : 0;
+	      job->index = i;
+	    }
 	  else
 	    {
 	      fork_execute (new_argv[0], CONST_CAST (char **, new_argv),
@@ -1398,36 +1778,22 @@ cont:
 
 	  output_names[i] = output_name;
 	}
-      if (parallel)
+      if (jobserver)
 	{
 	  struct pex_obj *pex;
-	  char jobs[32];
 
 	  fprintf (mstream, "all:");
 	  for (i = 0; i < nr; ++i)
 	    fprintf (mstream, " \\\n\t%s", output_names[i]);
 	  fprintf (mstream, "\n");
 	  fclose (mstream);
-	  if (!jobserver)
-	    {
-	      /* Avoid passing --jobserver-fd= and similar flags 
-		 unless jobserver mode is explicitly enabled.  */
-	      putenv (xstrdup ("MAKEFLAGS="));
-	      putenv (xstrdup ("MFLAGS="));
-	    }
 	  new_argv[0] = getenv ("MAKE");
 	  if (!new_argv[0])
 	    new_argv[0] = "make";
 	  new_argv[1] = "-f";
 	  new_argv[2] = makefile;
-	  i = 3;
-	  if (!jobserver)
-	    {
-	      snprintf (jobs, 31, "-j%d", parallel);
-	      new_argv[i++] = jobs;
-	    }
-	  new_argv[i++] = "all";
-	  new_argv[i++] = NULL;
+	  new_argv[3] = "all";
+	  new_argv[4] = NULL;
 	  pex = collect_execute (new_argv[0], CONST_CAST (char **, new_argv),
 				 NULL, NULL, PEX_SEARCH, false);
 	  do_wait (new_argv[0], pex);
@@ -1436,6 +1802,21 @@ cont:
 	  for (i = 0; i < nr; ++i)
 	    maybe_unlink (input_names[i]);
 	}
+      else if (parallel)
+	{
+	  run_ltrans_jobs (jobs, njobs, parallel);
+	  XDELETEVEC (jobs);
+	}
+      if (incremental_dir)
+	{
+	  for (i = 0; i < nr; ++i)
+	    if (cache_entries[i])
+	      {
+		ltrans_cache_store (cache_entries[i], output_names[i]);
+		free (cache_entries[i]);
+	      }
+	  free (cache_entries);
+	}
       for (i = 0; i < nr; ++i)
 	{
 	  fputs (output_names[i], stdout);
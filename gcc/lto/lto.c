@@ -2322,6 +2322,19 @@ wait_for_child ()
 }
 #endif
 
+/* Return the number of online processors, or 0 if it is unknown.  */
+
+static int
+lto_online_cpus (void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  if (n > 0)
+    return MIN (n, INT_MAX);
+#endif
+  return 0;
+}
+
 /* Stream out ENCODER into TEMP_FILENAME
    Fork if that seems to help.  */
 
@@ -3073,6 +3086,18 @@ do_whole_program_analysis (void)
 	lto_parallelism = 0;
     }
 
+  /* Each streaming process is a fork of the whole WPA heap and duplicates
+     its page tables and every page it touches, so do not run more of
+     them than there are processors, whatever -flto=N asked for.  */
+  if (lto_parallelism > 1)
+    {
+      int cpus = lto_online_cpus ();
+      if (cpus > 0 && lto_parallelism > cpus)
+	lto_parallelism = cpus;
+      if (lto_parallelism > PARAM_VALUE (PARAM_MAX_LTO_STREAMING_PARALLELISM))
+	lto_parallelism = PARAM_VALUE (PARAM_MAX_LTO_STREAMING_PARALLELISM);
+    }
+
   timevar_start (TV_PHASE_OPT_GEN);
 
   /* Note that since we are in WPA mode, materialize_cgraph will not
@@ -2177,6 +2177,26 @@ execute_ipa_summary_passes (ipa_opt_pass_d *ipa_pass)
     }
 }
 
+/* Push the timevar of PASS.  If per-function times are being recorded,
+   credit the time to the current function as well.  The function is
+   named by its assembler name if it is already known; passes must not be
+   the ones to compute it.  */
+
+static void
+pass_timevar_push (opt_pass *pass)
+{
+  if (g_timer && cfun && g_timer->function_times_p ())
+    {
+      tree decl = cfun->decl;
+      g_timer->push_function (pass->tv_id, DECL_UID (decl),
+			      DECL_ASSEMBLER_NAME_SET_P (decl)
+			      ? IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (decl))
+			      : function_name (cfun));
+    }
+  else
+    timevar_push (pass->tv_id);
+}
+
 /* Execute IPA_PASS function transform on NODE.  */
 
 static void
@@ -2198,7 +2218,7 @@ execute_one_ipa_transform_pass (struct cgraph_node *node,
 
   /* If a timevar is present, start it.  */
   if (pass->tv_id != TV_NONE)
-    timevar_push (pass->tv_id);
+    pass_timevar_push (pass);
 
   /* Run pre-pass verification.  */
   execute_todo (ipa_pass->function_transform_todo_flags_start);
@@ -2452,7 +2472,7 @@ execute_one_pass (opt_pass *pass)
 
   /* If a timevar is present, start it.  */
   if (pass->tv_id != TV_NONE)
-    timevar_push (pass->tv_id);
+    pass_timevar_push (pass);
 
   /* Run pre-pass verification.  */
   execute_todo (pass->todo_flags_start);
@@ -0,0 +1,7 @@
+template <class T> T f (T t) { return t + 1; }
+
+int
+g (int i)
+{
+  return f (i + 1);
+}
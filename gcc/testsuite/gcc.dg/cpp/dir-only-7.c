@@ -0,0 +1,17 @@
+/* -M with -fdirectives-only only processes the directives.  */
+/* { dg-do preprocess } */
+/* { dg-options "-M -fdirectives-only" } */
+
+/* Not a directive:
+#error directive inside block comment
+*/
+
+#include "dir-only-1.h"
+
+#ifndef GOT_HEADER
+#error dir-only-1.h not included
+#endif
+
+#if 0
+#include "nonexistent.h"
+#endif
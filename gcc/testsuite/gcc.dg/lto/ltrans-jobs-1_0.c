@@ -0,0 +1,23 @@
+/* Run more LTRANS partitions than -flto=N allows at a time, so that
+   lto-wrapper has to start new jobs as earlier ones finish.  */
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto=2 -flto-partition=max}} } */
+
+extern void abort (void);
+
+extern int f1 (int);
+extern int f2 (int);
+
+int __attribute__((noinline))
+f0 (int x)
+{
+  return f1 (x) + f2 (x);
+}
+
+int
+main (void)
+{
+  if (f0 (3) != 42)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,13 @@
+extern int f3 (int);
+
+int __attribute__((noinline))
+f1 (int x)
+{
+  return f3 (x) * 2;
+}
+
+int __attribute__((noinline))
+f3 (int x)
+{
+  return x + 4;
+}
@@ -0,0 +1,13 @@
+extern int f4 (int);
+
+int __attribute__((noinline))
+f2 (int x)
+{
+  return f4 (x) * 4;
+}
+
+int __attribute__((noinline))
+f4 (int x)
+{
+  return x + 4;
+}
@@ -0,0 +1,25 @@
+/* -ftime-report-format=json writes its report, with per-function times
+   keyed on each function, to the -ftime-report-file file rather than to
+   standard error.  */
+/* { dg-do compile } */
+/* { dg-options "-O -ftime-report -ftime-report-format=json -ftime-report-file=time-report-json-1.json" } */
+
+int
+foo (int *p, int n)
+{
+  int s = 0;
+  for (int i = 0; i < n; i++)
+    s += p[i];
+  return s;
+}
+
+int
+bar (int *p)
+{
+  return foo (p, 16) * 2;
+}
+
+/* { dg-final { scan-file time-report-json-1.json "^\\{\"input\": \"\[^\"\]*time-report-json-1\\.c\", \"total\": \\{\"name\": " } } */
+/* { dg-final { scan-file time-report-json-1.json "\"functions\": \\\[\[^\]\]*\\{\"name\": \"foo\", \"user\": " } } */
+/* { dg-final { scan-file time-report-json-1.json "\"functions\": \\\[\[^\]\]*\\{\"name\": \"bar\", \"user\": " } } */
+/* { dg-final { remove-build-file "time-report-json-1.json" } } */
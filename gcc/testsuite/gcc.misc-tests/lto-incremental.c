@@ -0,0 +1,19 @@
+extern int g (int);
+
+int
+f (int x)
+{
+  return g (x) * 3;
+}
+
+int
+g (int x)
+{
+  return x + 1;
+}
+
+int
+main (void)
+{
+  return f (0) != 3;
+}
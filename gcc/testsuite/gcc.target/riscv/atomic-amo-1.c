@@ -0,0 +1,26 @@
+/* Sequentially consistent AMOs carry both the .aq and .rl bits and need
+   no separate fence.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64ia -mabi=lp64" } */
+
+int
+add (int *p, int v)
+{
+  return __atomic_fetch_add (p, v, __ATOMIC_SEQ_CST);
+}
+
+int
+swap (int *p, int v)
+{
+  return __atomic_exchange_n (p, v, __ATOMIC_SEQ_CST);
+}
+
+void
+store (int *p, int v)
+{
+  __atomic_store_n (p, v, __ATOMIC_SEQ_CST);
+}
+
+/* { dg-final { scan-assembler "amoadd\\.w\\.aqrl" } } */
+/* { dg-final { scan-assembler-times "amoswap\\.w\\.aqrl" 2 } } */
+/* { dg-final { scan-assembler-not "fence" } } */
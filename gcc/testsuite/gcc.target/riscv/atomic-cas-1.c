@@ -0,0 +1,15 @@
+/* An acq_rel compare-and-swap puts the acquire on the LR and the release
+   on the SC, with no fence.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64ia -mabi=lp64" } */
+
+int
+f (int *p, int *o, int n)
+{
+  return __atomic_compare_exchange_n (p, o, n, 0, __ATOMIC_ACQ_REL,
+				      __ATOMIC_ACQUIRE);
+}
+
+/* { dg-final { scan-assembler "lr\\.w\\.aq " } } */
+/* { dg-final { scan-assembler "sc\\.w\\.rl " } } */
+/* { dg-final { scan-assembler-not "fence" } } */
@@ -0,0 +1,20 @@
+/* Acquire and release thread fences only need to order loads before,
+   respectively stores after, the fence.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64ia -mabi=lp64" } */
+
+void
+acquire (void)
+{
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+}
+
+void
+release (void)
+{
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+/* { dg-final { scan-assembler-times "fence\tr,rw" 1 } } */
+/* { dg-final { scan-assembler-times "fence\trw,w" 1 } } */
+/* { dg-final { scan-assembler-not "iorw" } } */
@@ -0,0 +1,14 @@
+/* Thread fences with no memory access between them are merged into one
+   fence that orders the union of what they order.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64ia -mabi=lp64" } */
+
+void
+f (void)
+{
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+/* { dg-final { scan-assembler-times "fence\t" 1 } } */
+/* { dg-final { scan-assembler "fence\trw,rw" } } */
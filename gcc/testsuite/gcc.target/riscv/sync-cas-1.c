@@ -0,0 +1,14 @@
+/* The __sync compare-and-swap is a full barrier: the SC must order later
+   accesses as well as earlier ones.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64ia -mabi=lp64" } */
+
+int
+f (int *p, int o, int n)
+{
+  return __sync_val_compare_and_swap (p, o, n);
+}
+
+/* { dg-final { scan-assembler "fence iorw,ow" } } */
+/* { dg-final { scan-assembler "lr\\.w\\.aqrl" } } */
+/* { dg-final { scan-assembler "sc\\.w\\.aqrl" } } */
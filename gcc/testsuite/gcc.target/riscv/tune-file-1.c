@@ -0,0 +1,12 @@
+/* A tuning description file can give several fields on a line.  Here
+   multiplication is made expensive enough to be synthesized.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64gc -mabi=lp64d -mtune=file:$srcdir/gcc.target/riscv/tune-file-1.tune" } */
+
+long
+f (long x)
+{
+  return x * 12345;
+}
+
+/* { dg-final { scan-assembler-not "\tmul\t" } } */
@@ -0,0 +1,11 @@
+/* Malformed tuning description entries are diagnosed.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -march=rv64gc -mabi=lp64d -mtune=file:$srcdir/gcc.target/riscv/tune-file-2.tune" } */
+
+int x;
+
+/* { dg-error ":2: invalid tuning description entry .fp_add." "" { target *-*-* } 0 } */
+/* { dg-error ":3: invalid tuning description entry .issue_rate." "" { target *-*-* } 0 } */
+/* { dg-error ":4: invalid tuning description entry .bogus_key." "" { target *-*-* } 0 } */
+/* { dg-error ":5: value .7. does not follow a key" "" { target *-*-* } 0 } */
+/* { dg-error ":6: line too long" "" { target *-*-* } 0 } */
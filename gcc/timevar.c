@@ -115,6 +115,11 @@ size_t timevar_ggc_mem_total;
 
 #define GGC_MEM_BOUND (1 << 20)
 
+/* The number of functions that take the most time that
+   -ftime-report-format=json reports for each timing variable.  */
+
+#define TIMEVAR_FUNCTION_ITEMS 10
+
 /* See timevar.h for an explanation of timing variables.  */
 
 static void get_time (struct timevar_time_def *);
@@ -289,6 +294,7 @@ timer::~timer ()
   for (iter = m_stack; iter; iter = next)
     {
       next = iter->next;
+      free (iter->function_name);
       free (iter);
     }
   for (iter = m_unused_stack_instances; iter; iter = next)
@@ -297,7 +303,13 @@ timer::~timer ()
       free (iter);
     }
   for (unsigned i = 0; i < TIMEVAR_LAST; ++i)
-    delete m_timevars[i].children;
+    {
+      delete m_timevars[i].children;
+      if (function_item *functions = m_timevars[i].functions)
+	for (unsigned j = 0; j < TIMEVAR_FUNCTION_ITEMS; j++)
+	  free (functions[j].name);
+      free (m_timevars[i].functions);
+    }
 
   delete m_jit_client_items;
 }
@@ -327,6 +339,31 @@ timer::push (timevar_id_t timevar)
   push_internal (tv);
 }
 
+/* Push TIMEVAR onto the timing stack like timer::push, and credit the
+   time until it is popped, including that of any timing variables
+   pushed on top of it, to the function FUNCTION_ID in the per-function
+   times of TIMEVAR.  Functions are told apart by FUNCTION_ID alone;
+   FUNCTION_NAME is copied, to be printed in the report.  */
+
+void
+timer::push_function (timevar_id_t timevar, unsigned int function_id,
+		      const char *function_name)
+{
+  push (timevar);
+  m_stack->function_name = xstrdup (function_name);
+  m_stack->function_id = function_id;
+  m_stack->start_time = m_start_time;
+}
+
+/* Return true if per-function times should be recorded with
+   push_function.  */
+
+bool
+timer::function_times_p () const
+{
+  return flag_time_report_format == TIME_REPORT_FORMAT_JSON;
+}
+
 /* Push TV onto the timing stack, either one of the builtin ones
    for a timevar_id_t, or one provided by client code to libgccjit.  */
 
@@ -369,6 +406,7 @@ timer::push_internal (struct timevar_def *tv)
   /* Fill it in and put it on the stack.  */
   context->timevar = tv;
   context->next = m_stack;
+  context->function_name = NULL;
   m_stack = context;
 }
 
@@ -417,6 +455,17 @@ timer::pop_internal ()
       timevar_accumulate (&time, &m_start_time, &now);
     }
 
+  if (popped->function_name)
+    {
+      timevar_time_def elapsed;
+      memset (&elapsed, 0, sizeof (elapsed));
+      timevar_accumulate (&elapsed, &popped->start_time, &now);
+      record_function_time (popped->timevar, popped->function_id,
+			    popped->function_name, elapsed);
+      free (popped->function_name);
+      popped->function_name = NULL;
+    }
+
   /* Reset the start time; from now on, time is attributed to the
      element just exposed on the stack.  */
   m_start_time = now;
@@ -670,6 +719,74 @@ timer::print_row (FILE *fp,
   putc ('\n', fp);
 }
 
+/* Credit ELAPSED to the function FUNCTION_ID, called FUNCTION_NAME, in
+   the per-function times of TV.  Only the TIMEVAR_FUNCTION_ITEMS
+   functions with the most user and system time are kept.  */
+
+void
+timer::record_function_time (timevar_def *tv, unsigned int function_id,
+			     const char *function_name,
+			     const timevar_time_def &elapsed)
+{
+  function_item *cheapest = NULL;
+  unsigned int i;
+
+  if (!tv->functions)
+    tv->functions = XCNEWVEC (function_item, TIMEVAR_FUNCTION_ITEMS);
+
+  for (i = 0; i < TIMEVAR_FUNCTION_ITEMS; i++)
+    {
+      function_item *item = &tv->functions[i];
+
+      /* Items are filled in order, so the first unused one ends the
+	 search.  */
+      if (!item->name)
+	{
+	  cheapest = item;
+	  break;
+	}
+      if (item->id == function_id)
+	{
+	  item->elapsed.user += elapsed.user;
+	  item->elapsed.sys += elapsed.sys;
+	  item->elapsed.wall += elapsed.wall;
+	  item->elapsed.ggc_mem += elapsed.ggc_mem;
+	  return;
+	}
+      if (!cheapest
+	  || (item->elapsed.user + item->elapsed.sys
+	      < cheapest->elapsed.user + cheapest->elapsed.sys))
+	cheapest = item;
+    }
+
+  if (!cheapest->name
+      || (elapsed.user + elapsed.sys
+	  > cheapest->elapsed.user + cheapest->elapsed.sys))
+    {
+      free (cheapest->name);
+      cheapest->id = function_id;
+      cheapest->name = xstrdup (function_name);
+      cheapest->elapsed = elapsed;
+    }
+}
+
+/* qsort comparison function sorting function items by decreasing user
+   and system time, with unused items last.  */
+
+int
+timer::function_item_cmp (const void *p1, const void *p2)
+{
+  const function_item *item1 = (const function_item *) p1;
+  const function_item *item2 = (const function_item *) p2;
+  double cost1, cost2;
+
+  if (!item1->name || !item2->name)
+    return !item1->name - !item2->name;
+  cost1 = item1->elapsed.user + item1->elapsed.sys;
+  cost2 = item2->elapsed.user + item2->elapsed.sys;
+  return cost1 < cost2 ? 1 : cost1 > cost2 ? -1 : 0;
+}
+
 /* Return whether ELAPSED is all zero.  */
 
 bool
@@ -792,6 +909,126 @@ timer::print (FILE *fp)
   validate_phases (fp);
 }
 
+/* Print STR to FP as a JSON string.  */
+
+static void
+print_json_string (FILE *fp, const char *str)
+{
+  putc ('"', fp);
+  for (; *str; str++)
+    {
+      unsigned char c = *str;
+      if (c == '"' || c == '\\')
+	fprintf (fp, "\\%c", c);
+      else if (c < 0x20)
+	fprintf (fp, "\\u%04x", c);
+      else
+	putc (c, fp);
+    }
+  putc ('"', fp);
+}
+
+/* Helper function for timer::print_json.  Print the JSON object for
+   the time ELAPSED by the item called NAME.  */
+
+void
+timer::print_json_row (FILE *fp, const char *name,
+		       const timevar_time_def &elapsed)
+{
+  fputs ("{\"name\": ", fp);
+  print_json_string (fp, name);
+  fprintf (fp, ", \"user\": %.6f, \"sys\": %.6f, \"wall\": %.6f"
+	   ", \"ggc_mem\": %lu}",
+	   elapsed.user, elapsed.sys, elapsed.wall,
+	   (unsigned long) elapsed.ggc_mem);
+}
+
+/* Summarize timing variables to FP as a single line holding a JSON
+   object, so that the reports of many compilations can be appended to
+   one file.  INPUT_NAME is the name of the file being compiled.  Unlike
+   timer::print, every timing variable that was used is listed, along
+   with its children for -ftime-report-details and the functions it
+   spent the most time on.  */
+
+void
+timer::print_json (FILE *fp, const char *input_name)
+{
+  unsigned int /* timevar_id_t */ id;
+  struct timevar_time_def now;
+  bool first = true;
+
+  /* Update timing information as timer::print does.  */
+  get_time (&now);
+  if (m_stack)
+    timevar_accumulate (&m_stack->timevar->elapsed, &m_start_time, &now);
+  m_start_time = now;
+
+  fputs ("{\"input\": ", fp);
+  print_json_string (fp, input_name ? input_name : "");
+  fputs (", \"total\": ", fp);
+  print_json_row (fp, m_timevars[TV_TOTAL].name,
+		  m_timevars[TV_TOTAL].elapsed);
+
+#ifdef HAVE_GETRUSAGE
+  {
+    struct rusage rusage;
+    if (getrusage (RUSAGE_SELF, &rusage) == 0)
+      fprintf (fp, ", \"peak_rss_kb\": %ld", (long) rusage.ru_maxrss);
+  }
+#endif
+
+  fputs (", \"timevars\": [", fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      timevar_def *tv = &m_timevars[(timevar_id_t) id];
+
+      if ((timevar_id_t) id == TV_TOTAL || !tv->used)
+	continue;
+
+      if (!first)
+	fputs (", ", fp);
+      first = false;
+
+      fputs ("{\"timevar\": ", fp);
+      print_json_row (fp, tv->name, tv->elapsed);
+
+      if (tv->children)
+	{
+	  bool first_child = true;
+	  fputs (", \"children\": [", fp);
+	  for (child_map_t::iterator i = tv->children->begin ();
+	       i != tv->children->end (); ++i)
+	    {
+	      if (!first_child)
+		fputs (", ", fp);
+	      first_child = false;
+	      print_json_row (fp, (*i).first->name, (*i).second);
+	    }
+	  putc (']', fp);
+	}
+
+      if (tv->functions)
+	{
+	  fputs (", \"functions\": [", fp);
+	  qsort (tv->functions, TIMEVAR_FUNCTION_ITEMS, sizeof (function_item),
+		 function_item_cmp);
+	  for (unsigned int i = 0;
+	       i < TIMEVAR_FUNCTION_ITEMS && tv->functions[i].name; i++)
+	    {
+	      if (i)
+		fputs (", ", fp);
+	      print_json_row (fp, tv->functions[i].name,
+			      tv->functions[i].elapsed);
+	    }
+	  putc (']', fp);
+	}
+
+      putc ('}', fp);
+    }
+
+  fputs ("]}\n", fp);
+}
+
 /* Get the name of the topmost item.  For use by jit for validating
    inputs to gcc_jit_timer_pop.  */
 const char *
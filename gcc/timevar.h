@@ -111,6 +111,8 @@ class timer
   void start (timevar_id_t tv);
   void stop (timevar_id_t tv);
   void push (timevar_id_t tv);
+  void push_function (timevar_id_t tv, unsigned int function_id,
+		      const char *function_name);
   void pop (timevar_id_t tv);
   bool cond_start (timevar_id_t tv);
   void cond_stop (timevar_id_t tv);
@@ -119,6 +121,9 @@ class timer
   void pop_client_item ();
 
   void print (FILE *fp);
+  void print_json (FILE *fp, const char *input_name);
+
+  bool function_times_p () const;
 
   const char *get_topmost_item_name () const;
 
@@ -133,10 +138,32 @@ class timer
 			 const timevar_time_def *total,
 			 const char *name, const timevar_time_def &elapsed);
   static bool all_zero (const timevar_time_def &elapsed);
+  static void record_function_time (struct timevar_def *tv,
+				    unsigned int function_id,
+				    const char *function_name,
+				    const timevar_time_def &elapsed);
+  static void print_json_row (FILE *fp, const char *name,
+			      const timevar_time_def &elapsed);
+  static int function_item_cmp (const void *, const void *);
 
  private:
   typedef hash_map<timevar_def *, timevar_time_def> child_map_t;
 
+  /* Private type: the time a timing variable spent on behalf of one
+     function.  */
+  struct function_item
+  {
+    /* The identifier of the function given to push_function.  */
+    unsigned int id;
+
+    /* A copy of the name of the function, or NULL for an unused
+       item.  */
+    char *name;
+
+    /* Elapsed time, including that of nested timing variables.  */
+    struct timevar_time_def elapsed;
+  };
+
   /* Private type: a timing variable.  */
   struct timevar_def
   {
@@ -159,6 +186,10 @@ class timer
     unsigned used : 1;
 
     child_map_t *children;
+
+    /* If non-NULL, the functions this variable spent the most time on,
+       for -ftime-report-format=json.  */
+    function_item *functions;
   };
 
   /* Private type: an element on the timing stack
@@ -171,6 +202,13 @@ class timer
 
     /* The next lower timing variable context in the stack.  */
     struct timevar_stack_def *next;
+
+    /* If non-NULL, a copy of the name of the function this level was
+       pushed for by push_function, its identifier, and the time at which
+       that happened.  */
+    char *function_name;
+    unsigned int function_id;
+    struct timevar_time_def start_time;
   };
 
   /* A class for managing a collection of named timing items, for use
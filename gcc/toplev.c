@@ -2025,8 +2025,32 @@ toplev::~toplev ()
 {
   if (g_timer && m_use_TV_TOTAL)
     {
+      FILE *fp = stderr;
+
       g_timer->stop (TV_TOTAL);
-      g_timer->print (stderr);
+
+      /* Write the whole report with as few appending writes as possible,
+	 so that reports of parallel compilations do not get mixed up.  */
+      if (time_report_file)
+	{
+	  fp = fopen (time_report_file, "a");
+	  if (fp)
+	    setvbuf (fp, NULL, _IOFBF, 1 << 20);
+	  else
+	    {
+	      fnotice (stderr, "cannot open time report file %s: %s\n",
+		       time_report_file, xstrerror (errno));
+	      fp = stderr;
+	    }
+	}
+
+      if (flag_time_report_format == TIME_REPORT_FORMAT_JSON)
+	g_timer->print_json (fp, main_input_filename);
+      else
+	g_timer->print (fp);
+
+      if (fp != stderr)
+	fclose (fp);
       delete g_timer;
       g_timer = NULL;
     }
@@ -1609,6 +1609,7 @@ perform_tree_ssa_dce (bool aggressive)
   nr_walks = 0;
   chain_ovfl = false;
   visited = BITMAP_ALLOC (NULL);
+  bitmap_tree_view (visited);
   propagate_necessity (aggressive);
   BITMAP_FREE (visited);
 
@@ -2006,6 +2006,21 @@ _cpp_interpret_identifier (cpp_reader *pfile, const uchar *id, size_t len)
 				  buf, bufp - buf, HT_ALLOC));
 }
 
+/* Return true if source files in INPUT_CHARSET are used as they are,
+   without conversion to the source character set.  */
+bool
+_cpp_input_charset_trivial_p (cpp_reader *pfile, const char *input_charset)
+{
+  struct cset_converter input_cset;
+  bool trivial;
+
+  input_cset = init_iconv_desc (pfile, SOURCE_CHARSET, input_charset);
+  trivial = input_cset.func == convert_no_conversion;
+  if (input_cset.func == convert_using_iconv)
+    iconv_close (input_cset.cd);
+  return trivial;
+}
+
 /* Convert an input buffer (containing the complete contents of one
    source file) from INPUT_CHARSET to the source character set.  INPUT
    points to the input buffer, SIZE is its allocated size, and LEN is
@@ -31,6 +31,43 @@ along with this program; see the file COPYING3.  If not see
 #define DO_LINE_SPECIAL (DO_STRING | DO_CHAR | DO_LINE_COMMENT)
 #define DO_SPECIAL	(DO_LINE_SPECIAL | DO_BLOCK_COMMENT)
 
+/* CUR points to a '"' preceded by an 'R', outside of any comment or
+   literal, in a buffer starting at BASE.  If it starts a raw string
+   literal, return a pointer to its closing '"', else NULL.  */
+
+static const unsigned char *
+raw_string_end (cpp_reader *pfile, const unsigned char *base,
+		const unsigned char *cur, const unsigned char *rlimit)
+{
+  const unsigned char *p = cur - 1, *delim, *q;
+  size_t len;
+
+  /* The R may follow an encoding prefix, but no other identifier
+     characters.  */
+  if (p > base && (p[-1] == 'u' || p[-1] == 'U' || p[-1] == 'L'))
+    p--;
+  else if (p - 1 > base && p[-1] == '8' && p[-2] == 'u')
+    p -= 2;
+  if (p > base && is_idchar (p[-1]))
+    return NULL;
+
+  /* Read the delimiter, which is at most 16 characters long.  */
+  delim = cur + 1;
+  for (q = delim; q < rlimit && *q != '('; q++)
+    if (q - delim == 16 || *q == ')' || *q == '\\' || ISSPACE (*q))
+      return NULL;
+  if (q == rlimit)
+    return NULL;
+  len = q - delim;
+
+  for (q++; q < rlimit; q++)
+    if (*q == ')' && (size_t) (rlimit - q) > len + 1
+	&& memcmp (q + 1, delim, len) == 0 && q[len + 1] == '"')
+      return q + len + 1;
+
+  return NULL;
+}
+
 /* Writes out the preprocessed file, handling spacing and paste
    avoidance issues.  */
 void
@@ -129,6 +166,29 @@ _cpp_preprocess_dir_only (cpp_reader *pfile,
 	  pfile->mi_valid = false;
 	}
 
+      /* Skip over raw string literals as a whole, since they may contain
+	 anything, including lines that look like directives.  */
+      if (__builtin_expect (c == '"', false) && last_c == 'R'
+	  && !(flags & DO_SPECIAL) && CPP_OPTION (pfile, rliterals))
+	{
+	  const unsigned char *end = raw_string_end (pfile, buffer->buf,
+						     cur, rlimit);
+	  if (end)
+	    {
+	      for (; cur < end; cur++, col++)
+		if (*cur == '\n')
+		  {
+		    CPP_INCREMENT_LINE (pfile, 0);
+		    lines++;
+		    col = 0;
+		  }
+	      flags &= ~DO_BOL;
+	      pfile->mi_valid = false;
+	      c = 0;
+	      continue;
+	    }
+	}
+
       switch (c)
 	{
 	case '/':
@@ -48,6 +48,12 @@ along with this program; see the file COPYING3.  If not see
 #  define set_stdin_to_binary_mode() /* Nothing */
 #endif
 
+/* Map source files into memory instead of reading them, where the host
+   supports it.  */
+#if defined HAVE_SYS_MMAN_H && defined MAP_PRIVATE && defined _SC_PAGESIZE
+# define USE_MMAP
+#endif
+
 /* This structure represents a file searched for by CPP, whether it
    exists or not.  An instance may be pointed to by more than one
    cpp_file_hash_entry; at present no reference count is kept.  */
@@ -76,6 +82,16 @@ struct _cpp_file
      BUFFER; when freeing, this this pointer must be used instead.  */
   const uchar *buffer_start;
 
+  /* An unmodified copy of the contents of NAME, including the
+     terminating newline and padding, made when the file is stacked a
+     second time so that further inclusions need not read it again.  */
+  const uchar *saved_buffer;
+
+  /* If non-NULL, a private mapping of the file of MAPPED_SIZE bytes,
+     which is or was BUFFER_START.  It must be unmapped, not freed.  */
+  const uchar *mapped;
+  size_t mapped_size;
+
   /* The macro, if any, preventing re-inclusion.  */
   const cpp_hashnode *cmacro;
 
@@ -187,6 +203,7 @@ static struct cpp_file_hash_entry *search_cache (struct cpp_file_hash_entry *hea
 					     const cpp_dir *start_dir);
 static _cpp_file *make_cpp_file (cpp_reader *, cpp_dir *, const char *fname);
 static void destroy_cpp_file (_cpp_file *);
+static void free_file_buffer (_cpp_file *, const uchar *);
 static cpp_dir *make_cpp_dir (cpp_reader *, const char *dir_name, int sysp);
 static void allocate_file_hash_entries (cpp_reader *pfile);
 static struct cpp_file_hash_entry *new_file_hash_entry (cpp_reader *pfile);
@@ -660,6 +677,79 @@ _cpp_find_file (cpp_reader *pfile, const char *fname, cpp_dir *start_dir,
   return file;
 }
 
+#ifdef USE_MMAP
+/* Try to map the regular file FILE, of SIZE bytes, into memory as
+   FILE->buffer instead of reading it.  This is only done if no charset
+   conversion is needed, and if the last page of the file has room for
+   the '\n' terminator and the 15 bytes of padding that the lexer
+   expects after the contents; the rest of that page reads as zeroes.
+   The mapping is private, since _cpp_clean_line modifies the buffer.
+   Return true if the file was mapped.  */
+
+static bool
+map_file (cpp_reader *pfile, _cpp_file *file, size_t size)
+{
+  static long page_size;
+  uchar *buf;
+
+  if (file->mapped)
+    return false;
+
+  if (!page_size)
+    page_size = sysconf (_SC_PAGESIZE);
+  if (page_size <= 0
+      || size % page_size == 0
+      || (size_t) page_size - size % page_size < 16)
+    return false;
+
+  if (!_cpp_input_charset_trivial_p (pfile,
+				     CPP_OPTION (pfile, input_charset)))
+    return false;
+
+  buf = (uchar *) mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			file->fd, 0);
+  if (buf == (uchar *) MAP_FAILED)
+    return false;
+
+  file->mapped = buf;
+  file->mapped_size = size;
+
+  /* Terminate the buffer as _cpp_convert_input does.  */
+  buf[size] = buf[size - 1] == '\r' ? '\r' : '\n';
+
+  file->buffer_start = buf;
+  file->buffer = buf;
+  file->st.st_size = size;
+#if HOST_CHARSET == HOST_CHARSET_ASCII
+  /* Ignore a UTF-8 BOM, as _cpp_convert_input does.  */
+  if (size >= 3 && buf[0] == 0xef && buf[1] == 0xbb && buf[2] == 0xbf)
+    {
+      file->buffer += 3;
+      file->st.st_size -= 3;
+    }
+#endif
+  file->buffer_valid = true;
+
+  return true;
+}
+#endif
+
+/* Free BUF, which is or was the buffer of FILE.  */
+
+static void
+free_file_buffer (_cpp_file *file, const uchar *buf)
+{
+#ifdef USE_MMAP
+  if (buf && buf == file->mapped)
+    {
+      munmap ((void *) buf, file->mapped_size);
+      file->mapped = NULL;
+      return;
+    }
+#endif
+  free ((void *) buf);
+}
+
 /* Read a file into FILE->buffer, returning true on success.
 
    If FILE->fd is something weird, like a block device, we don't want
@@ -703,6 +793,13 @@ read_file_guts (cpp_reader *pfile, _cpp_file *file, source_location loc)
 	}
 
       size = file->st.st_size;
+
+#ifdef USE_MMAP
+      if (size > 0
+	  && STAT_SIZE_RELIABLE (file->st)
+	  && map_file (pfile, file, size))
+	return true;
+#endif
     }
   else
     /* 8 kilobytes is a sensible starting size.  It ought to be bigger
@@ -761,6 +858,16 @@ read_file (cpp_reader *pfile, _cpp_file *file, source_location loc)
   if (file->buffer_valid)
     return true;
 
+  /* If the file is included repeatedly, use the copy we kept.  */
+  if (file->saved_buffer)
+    {
+      uchar *buf = XNEWVEC (uchar, file->st.st_size + 16);
+      memcpy (buf, file->saved_buffer, file->st.st_size + 16);
+      file->buffer = file->buffer_start = buf;
+      file->buffer_valid = true;
+      return true;
+    }
+
   /* If an earlier read failed for some reason don't try again.  */
   if (file->dont_read || file->err_no)
     return false;
@@ -818,6 +925,19 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import,
       return false;
     }
 
+  /* A once-only file reached through another path, for instance through
+     a symbolic link or a duplicate -I, is recognized by its identity
+     without reading it.  */
+  if (pfile->seen_once_only && file->st.st_ino != 0)
+    for (f = pfile->all_files; f; f = f->next_file)
+      if (f != file
+	  && (import || f->once_only)
+	  && f->err_no == 0
+	  && f->st.st_ino == file->st.st_ino
+	  && f->st.st_dev == file->st.st_dev
+	  && f->st.st_mtime == file->st.st_mtime)
+	return false;
+
   if (!read_file (pfile, file, loc))
     return false;
 
@@ -912,6 +1032,18 @@ _cpp_stack_file (cpp_reader *pfile, _cpp_file *file, bool import,
 	deps_add_dep (pfile->deps, file->path);
     }
 
+  /* A file without a multiple-include guard that is stacked a second
+     time, such as a header of X-macros, is likely to be stacked many
+     more times.  Keep a copy of its contents before _cpp_clean_line
+     modifies them, rather than opening and reading it again each
+     time.  */
+  if (file->stack_count == 1 && !file->cmacro && !file->saved_buffer)
+    {
+      uchar *copy = XNEWVEC (uchar, file->st.st_size + 16);
+      memcpy (copy, file->buffer, file->st.st_size + 16);
+      file->saved_buffer = copy;
+    }
+
   /* Clear buffer_valid since _cpp_clean_line messes it up.  */
   file->buffer_valid = false;
   file->stack_count++;
@@ -1130,7 +1262,13 @@ make_cpp_file (cpp_reader *pfile, cpp_dir *dir, const char *fname)
 static void
 destroy_cpp_file (_cpp_file *file)
 {
-  free ((void *) file->buffer_start);
+  free_file_buffer (file, file->buffer_start);
+#ifdef USE_MMAP
+  /* The mapping may have been replaced as the buffer while stacked.  */
+  if (file->mapped)
+    munmap ((void *) file->mapped, file->mapped_size);
+#endif
+  free ((void *) file->saved_buffer);
   free ((void *) file->name);
   free ((void *) file->path);
   free (file);
@@ -1515,7 +1653,7 @@ _cpp_pop_file_buffer (cpp_reader *pfile, _cpp_file *file,
 	  file->buffer = NULL;
 	  file->buffer_valid = false;
 	}
-      free ((void *) to_free);
+      free_file_buffer (file, to_free);
     }
 }
 
@@ -159,7 +159,7 @@ acc_char_replicate (uchar x)
   return ret;
 }
 
-/* Return non-zero if some byte of VAL is (probably) C.  */
+/* Return non-zero if some byte of VAL is C.  */
 
 static inline word_type
 acc_char_cmp (word_type val, word_type c)
@@ -169,13 +169,15 @@ acc_char_cmp (word_type val, word_type c)
      Get (val == c) via (0 >= (val ^ c)).  */
   return __builtin_alpha_cmpbge (0, val ^ c);
 #else
-  word_type magic = 0x7efefefeU;
-  if (sizeof(word_type) == 8)
-    magic = (magic << 16 << 16) | 0xfefefefeU;
-  magic |= 1;
+  /* Set the high bit of each byte of VAL ^ C that is zero.  A byte
+     above (more significant than) a zero byte may be flagged as well,
+     because of the borrow, but the result is non-zero exactly when some
+     byte matches, and its least significant set bit is always exact.  */
+  const word_type ones = acc_char_replicate (0x01);
+  const word_type highs = ones << 7;
 
   val ^= c;
-  return ((val + magic) ^ ~val) & ~magic;
+  return (val - ones) & ~val & highs;
 #endif
 }
 
@@ -190,6 +192,13 @@ acc_char_index (word_type cmp ATTRIBUTE_UNUSED,
   /* The cmpbge instruction sets *bits* of the result corresponding to
      matches in the bytes with no false positives.  */
   return __builtin_ctzl (cmp);
+#elif defined(__GNUC__) && !WORDS_BIGENDIAN
+  /* The first byte in memory is the least significant one, and the
+     least significant bit set by acc_char_cmp is exact.  */
+  if (sizeof(word_type) == 8)
+    return __builtin_ctzll (cmp) / 8;
+  else
+    return __builtin_ctz (cmp) / 8;
 #else
   unsigned int i;
 
@@ -910,6 +919,59 @@ search_line_fast (const uchar *s, const uchar *end ATTRIBUTE_UNUSED)
   return (const uchar *)p + found;
 }
 
+#elif defined (__GNUC__) && defined (__riscv) && defined (__riscv_zbb)
+
+/* A version of the fast scanner for RISC-V with the Zbb extension.
+   The orc.b instruction sets each byte of the result to 0xff if the
+   corresponding byte of its operand is non-zero, and to zero otherwise,
+   which gives an exact byte compare in two instructions.  */
+
+static inline word_type
+riscv_orc_b (word_type x)
+{
+  word_type r;
+  __asm__ ("orc.b %0, %1" : "=r" (r) : "r" (x));
+  return r;
+}
+
+static const uchar *
+search_line_fast (const uchar *s, const uchar *end ATTRIBUTE_UNUSED)
+{
+  const word_type repl_nl = acc_char_replicate ('\n');
+  const word_type repl_cr = acc_char_replicate ('\r');
+  const word_type repl_bs = acc_char_replicate ('\\');
+  const word_type repl_qm = acc_char_replicate ('?');
+
+  const word_type *p;
+  word_type val, t, mask;
+
+  /* Align the buffer.  Mask out any matches from before the beginning;
+     RISC-V is little-endian, so those are the low order bytes.  */
+  p = (const word_type *)((uintptr_t)s & -sizeof(word_type));
+  mask = (word_type) -1 << ((uintptr_t)s & (sizeof(word_type) - 1)) * 8;
+
+  val = *p;
+  while (1)
+    {
+      /* T has all bits of a byte set iff that byte is one of the
+	 interesting characters.  */
+      t = ~(riscv_orc_b (val ^ repl_nl)
+	    & riscv_orc_b (val ^ repl_cr)
+	    & riscv_orc_b (val ^ repl_bs)
+	    & riscv_orc_b (val ^ repl_qm));
+      t &= mask;
+      if (__builtin_expect (t != 0, 0))
+	break;
+      mask = -1;
+      val = *++p;
+    }
+
+  if (sizeof(word_type) == 8)
+    return (const uchar *)p + __builtin_ctzll (t) / 8;
+  else
+    return (const uchar *)p + __builtin_ctz (t) / 8;
+}
+
 #else
 
 /* We only have one accelerated alternative.  Use a direct call so that
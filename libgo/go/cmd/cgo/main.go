@@ -156,6 +156,7 @@ var ptrSizeMap = map[string]int64{
 	"ppc":      4,
 	"ppc64":    8,
 	"ppc64le":  8,
+	"riscv64":  8,
 	"s390":     4,
 	"s390x":    8,
 	"sparc":    4,
@@ -180,6 +181,7 @@ var intSizeMap = map[string]int64{
 	"ppc":      4,
 	"ppc64":    8,
 	"ppc64le":  8,
+	"riscv64":  8,
 	"s390":     4,
 	"s390x":    8,
 	"sparc":    4,
@@ -3,8 +3,8 @@
 // license that can be found in the LICENSE file.
 
 // GNU/Linux library ustat call.
-// This is not supported on some kernels, such as arm64.
-// +build !arm64
+// This is not supported on some kernels, such as arm64 and riscv64.
+// +build !arm64,!riscv64
 
 package syscall
 
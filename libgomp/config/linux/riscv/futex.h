@@ -0,0 +1,84 @@
+/* Copyright (C) 2017 Free Software Foundation, Inc.
+
+   This file is part of the GNU Offloading and Multi Processing Library
+   (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* Provide target-specific access to the futex system call.  */
+
+#include <sys/syscall.h>
+
+static inline long
+sys_futex0 (int *addr, int op, int val)
+{
+  register long int a0  __asm__ ("a0");
+  register long int a1  __asm__ ("a1");
+  register long int a2  __asm__ ("a2");
+  register long int a3  __asm__ ("a3");
+  register long int a7  __asm__ ("a7");
+
+  a0 = (long) addr;
+  a1 = op;
+  a2 = val;
+  a3 = 0;
+  a7 = SYS_futex;
+
+  __asm volatile ("ecall"
+		  : "=r" (a0)
+		  : "r" (a7), "0" (a0), "r" (a1), "r" (a2), "r" (a3)
+		  : "memory");
+  return a0;
+}
+
+static inline void
+futex_wait (int *addr, int val)
+{
+  long err = sys_futex0 (addr, gomp_futex_wait, val);
+  if (__builtin_expect (err == -ENOSYS, 0))
+    {
+      gomp_futex_wait &= ~FUTEX_PRIVATE_FLAG;
+      gomp_futex_wake &= ~FUTEX_PRIVATE_FLAG;
+      sys_futex0 (addr, gomp_futex_wait, val);
+    }
+}
+
+static inline void
+futex_wake (int *addr, int count)
+{
+  long err = sys_futex0 (addr, gomp_futex_wake, count);
+  if (__builtin_expect (err == -ENOSYS, 0))
+    {
+      gomp_futex_wait &= ~FUTEX_PRIVATE_FLAG;
+      gomp_futex_wake &= ~FUTEX_PRIVATE_FLAG;
+      sys_futex0 (addr, gomp_futex_wake, count);
+    }
+}
+
+/* Hint to the core that we are in a spin-wait loop.  This is the
+   "fence w,0" HINT encoding, which executes as a no-op on cores that
+   do not implement it, so it is emitted by value to avoid depending on
+   assembler support for a mnemonic.  */
+
+static inline void
+cpu_relax (void)
+{
+  __asm volatile (".4byte 0x0100000f" : : : "memory");
+}